@@ -0,0 +1,75 @@
+#include "TimezoneRules.h"
+
+#define TZ_SECS_PER_MIN                           60
+#define TZ_SECS_PER_DAY                           86400L
+
+/**
+ * @brief Days since 1970 of a date in the Gregorian calendar
+ *
+ * Counts years from March so the leap day comes last, then every 400 years repeat exactly.
+ */
+static int32_t daysFromCivil(int year, uint8_t month, uint8_t day) {
+  year -= month <= 2;
+  int32_t era = (year >= 0 ? year : year - 399) / 400;
+  uint32_t yearOfEra = year - era * 400;
+  uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+  return era * 146097 + (int32_t) dayOfEra - 719468;
+}
+
+/**
+ * @brief Calendar year a time falls in, the inverse of daysFromCivil()
+ */
+static int yearOf(time_t time) {
+  int32_t days = time / TZ_SECS_PER_DAY - (time % TZ_SECS_PER_DAY < 0) + 719468;
+  int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+  uint32_t dayOfEra = days - era * 146097;
+  uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+
+  // Days past February 28 or 29 count toward the next calendar year
+  return yearOfEra + era * 400 + (dayOfYear >= 306);
+}
+
+/**
+ * @brief When a rule changes the clocks in a given year
+ *
+ * @param rule Daylight saving start or end.
+ * @param year Calendar year.
+ * @return The change as seconds since the epoch, in the local time the rule is given in.
+ */
+time_t timezoneRuleTime(const TzRule_t &rule, int year) {
+  int32_t first = daysFromCivil(year, rule.month, 1);
+  int32_t next = rule.month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, rule.month + 1, 1);
+
+  // 1970 started on a Thursday
+  uint8_t firstDow = ((first + 4) % 7 + 7) % 7;
+  int32_t day = first + (rule.dow + 7 - firstDow) % 7 + (rule.week - 1) * 7;
+  if (day >= next) {
+    day -= 7;  // week 5 is the last one, which may be the fourth
+  }
+
+  return (time_t) day * TZ_SECS_PER_DAY + rule.minute * TZ_SECS_PER_MIN;
+}
+
+/**
+ * @brief Whether a zone is on daylight saving time at a moment
+ */
+bool timezoneIsDst(const Timezone_t &zone, time_t utc) {
+  if (!(zone.flags & TZ_FLAG_DST)) return false;
+
+  int y = yearOf(utc + zone.stdOffset * TZ_SECS_PER_MIN);
+  time_t start = timezoneRuleTime(zone.dstStart, y) - zone.stdOffset * TZ_SECS_PER_MIN;
+  time_t end = timezoneRuleTime(zone.dstEnd, y) - zone.dstOffset * TZ_SECS_PER_MIN;
+
+  // Southern zones start daylight saving late in the year and end it early the next
+  return start < end ? utc >= start && utc < end : utc >= start || utc < end;
+}
+
+/**
+ * @brief Convert a UTC time to a zone's local time
+ */
+time_t toLocal(const Timezone_t &zone, time_t utc) {
+  return utc + (timezoneIsDst(zone, utc) ? zone.dstOffset : zone.stdOffset) * TZ_SECS_PER_MIN;
+}
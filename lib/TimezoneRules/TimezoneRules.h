@@ -0,0 +1,46 @@
+// =-------------------------------------------------------------------------------= Time Zones =--=
+//
+// The clock's daylight saving rules, kept apart from the firmware so `pio test -e native` can check
+// them against zoneinfo on the host.
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#define TZ_NAME_SIZE                              40
+#define TZ_ABBREV_SIZE                            8
+#define TZ_FLAG_DST                               0x01
+#define TZ_FLAG_ALIAS                             0x02 // old or backward compatible name, not listed
+
+/**
+ * A POSIX style Mm.w.d/time rule for when daylight saving starts or ends
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t month;                // 1-12
+  uint8_t week;                 // 1-4, 5 is the last in the month
+  uint8_t dow;                  // 0 is Sunday
+  uint8_t reserved;
+  int16_t minute;               // local time of the change, may be negative or past midnight
+} TzRule_t;
+
+/**
+ * One zone's record in the time zone database, also kept as the current zone
+ */
+typedef struct __attribute__((packed)) {
+  char     name[TZ_NAME_SIZE];  // IANA name
+  char     stdAbbrev[TZ_ABBREV_SIZE];
+  char     dstAbbrev[TZ_ABBREV_SIZE];
+  int16_t  stdOffset;           // minutes east of UTC
+  int16_t  dstOffset;
+  TzRule_t dstStart;            // in standard time
+  TzRule_t dstEnd;              // in daylight saving time
+  uint8_t  flags;
+  uint8_t  reserved[3];
+} Timezone_t;
+
+static_assert(sizeof(Timezone_t) == 76, "Timezone_t must match the records bin/tzdb-compile writes");
+
+time_t timezoneRuleTime(const TzRule_t &rule, int year);
+bool timezoneIsDst(const Timezone_t &zone, time_t utc);
+time_t toLocal(const Timezone_t &zone, time_t utc);
@@ -14,15 +14,72 @@ AutoConnect Portal(Server);
 AutoConnectConfig Config;
 AutoConnectAux ConfigureContainer;
 bool wifiFeaturesEnabled = false;
+EventClient_t eventClients[EVENTS_MAX_CLIENTS]; // open /api/events streams
 
 // NTP
-WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP);
-Timezone_t currentTZ = TZ_LIST[0];
+udp_pcb *ntpPcb = nullptr;
+NtpClient_t ntp;
+NtpServer_t ntpServers[NTP_SERVER_COUNT];
+NtpReply_t ntpReplies[NTP_SERVER_COUNT]; // set aside by onNtpPacket() until readNtpReplies()
+uint8_t ntpReplyCount = 0;
+ClockDiscipline_t clockDiscipline;
+ClockSample_t clockHistory[NTP_HISTORY_SIZE];
+uint32_t clockSamples = 0;            // samples ever taken, the history ring's head
+Timezone_t currentTZ = TZ_UTC;
 bool initialTimeSync = false;
 
 // Display
-CRGB leds[NUM_LEDS];
+alignas(4) uint8_t matrixPool[MATRIX_POOL_SIZE]; // storage of both matrices, see placeMatrix()
+Matrix_t matrices[2];
+Matrix_t *drawMatrix = &matrices[0];  // the matrix programs are currently drawing into
+CRGB *leds = (CRGB *) matrixPool;     // full virtual matrix that programs draw into
+uint8_t *indexedLeds = matrixPool;    // the same matrix as palette indices
+alignas(4) CRGB frame[NUM_PHYSICAL_LEDS]; // colors of the wired LEDs as last presented
+alignas(4) CRGB outputLeds[NUM_PHYSICAL_LEDS]; // frame after brightness, gamma and dithering, owned by FastLED
+uint16_t outputLut[3][256];           // per-channel brightness, gamma and white balance, 8.8 fixed point
+uint8_t ditherFrame = 0;              // advances the temporal dither pattern once per frame written
+#if DITHER_REFRESH_MS
+bool ditherActive = false;            // the last frame written has dim fractions for the dither to carry
+uint32_t ditherWrittenMs = 0;         // when the last frame was written out
+#endif
+CRGB *const transitionFrame = outputLeds; // outgoing program during a transition, until writeOutput()
+CRGB paletteLut[256];                 // colors of the palette indices in the live indexed matrix
+Transition_t transition;
+DisplayStats_t displayStats;
+FrameStats_t frameStats;
+Histogram_t edgeError;                // start of edge aligned frames after the second edge
+uint32_t nextFrameMs = 0;             // deadline of the next frame
+DigitState_t digitState[DIGIT_COUNT];
+
+// Scheduler
+SchedulerStats_t schedulerStats;
+
+// Profiler
+Histogram_t stageProfile[PROFILE_STAGE_COUNT];
+Histogram_t renderProfile[PROGRAM_COUNT];
+Histogram_t presentProfile[PROGRAM_COUNT]; // includes the show
+StallRecord_t stallRecord;            // mirror of the breadcrumbs in RTC memory
+uint8_t outerStage[STALL_MAX_DEPTH];  // breadcrumb of the stage enclosing each depth, for endStage()
+uint8_t outerProgram[STALL_MAX_DEPTH];
+StallRecord_t lastStall;              // breadcrumbs left by the run before the last reset
+bool lastStallValid = false;
+char lastResetReason[32] = "";
+
+// Preview
+PreviewServer_t previewSocket(PREVIEW_PORT);
+PreviewViewer_t previewViewers[PREVIEW_MAX_VIEWERS];
+
+// Logging
+char logBuffer[LOG_BUFFER_SIZE];      // ring of the most recent log text
+uint32_t logWritten = 0;              // bytes ever logged, the ring's head
+uint32_t logSent = 0;                 // bytes ever handed to the UART
+uint32_t logDropped = 0;              // bytes overwritten before the UART got to them
+
+// Stream
+WiFiUDP streamUDP;
+StreamBuffer_t stream;
+StreamStats_t streamStats;
+Histogram_t streamLatency;            // push received to the frame being drawn
 
 // OTA
 BearSSL::PublicKey signPubKey(OTA_PUBKEY);
@@ -30,9 +87,6 @@ BearSSL::HashSHA256 hash;
 BearSSL::SigningVerifier sign(&signPubKey);
 bool otaInProgress = false;
 
-// Palettes
-CRGBPalette16 currentPalette;
-
 
 // =--------------------------------------------------------------------------= WiFi and Portal =--=
 
@@ -46,12 +100,8 @@ void setupPortal() {
   // Load aux. page
   ConfigureContainer.load(PORTAL_CONFIGURE_PAGE);
 
-  // Fill the time zone selector from config and pre-select any saved value
-  AutoConnectSelect& timezoneSelector = ConfigureContainer["timezone"].as<AutoConnectSelect>();
-  for (uint8_t index = 0; index < sizeof(TZ_LIST) / sizeof(Timezone_t); index++) {
-    timezoneSelector.add(String(TZ_LIST[index].name));
-  }
-  timezoneSelector.select(String(currentTZ.name));
+  // Pre-fill the saved time zone, the page fetches the choices from /api/timezones itself
+  ConfigureContainer["timezone"].as<AutoConnectInput>().value = currentTZ.name;
 
   // Fill the program selector from config and pre-select from runtime value
   AutoConnectSelect& programSelector = ConfigureContainer["program"].as<AutoConnectSelect>();
@@ -65,6 +115,15 @@ void setupPortal() {
   // Behavior a root path of ESP8266WebServer.
   Server.on("/", portalRootPage);
   Server.on("/start", portalStartPage);   // Set NTP server trigger handler
+  Server.on("/api/timezones", portalTimezonesPage);
+  Server.on("/api/status", portalStatusPage);
+  Server.on("/api/events", portalEventsPage);
+  Server.on("/preview", portalPreviewPage);
+  Server.on("/api/layout", portalLayoutPage);
+  Server.on("/api/clock", portalClockPage);
+  Server.on("/metrics", portalMetricsPage);
+  Server.on("/stall", portalStallPage);
+  Server.on("/log", portalLogPage);
 
   // Set display to show state
   Portal.whileCaptivePortal(loopCaptivePortal);
@@ -76,75 +135,76 @@ void setupPortal() {
 
   // Fire up the network connection and portal with metrics
   unsigned long start = millis();
-  Serial.println("Starting Portal.begin");
+  LOG_INFO("Starting Portal.begin");
 
   if (Portal.begin()) {
-    Serial.printf("Portal.begin complete in %ld\n", millis() - start);
+    LOG_INFO("Portal.begin complete in %ld", millis() - start);
     // Serial.println("WiFi connected: " + WiFi.localIP().toString());
     if (MDNS.begin(MDNS_HOSTNAME)) {
       MDNS.addService("http", "tcp", 80);
     }
   }
 
-  Serial.printf("Portal setup complete in %ld\n", millis() - start);
+  LOG_INFO("Portal setup complete in %ld", millis() - start);
 }
 
 void loopPortal() {
+  uint32_t start = beginStage(PROFILE_PORTAL, currentProgram);
   Portal.handleClient();
+  endStage(PROFILE_PORTAL, currentProgram, start);
+
+  start = beginStage(PROFILE_MDNS, currentProgram);
   MDNS.update();
+  endStage(PROFILE_MDNS, currentProgram, start);
 }
 
+/**
+ * @brief Serve the status page
+ *
+ * The page is streamed from flash around the one dynamic value, which is formatted on the stack, so
+ * serving it never touches the heap beyond the web server's own buffers.
+ */
 void portalRootPage() {
-  String  content =
-    "<html>"
-    "<head>"
-    "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">"
-    "<script type=\"text/javascript\">setTimeout(\"location.reload()\", 10000);</script>"
-    "</head>"
-    "<body>"
-    "<h2 align=\"center\" style=\"color:black;margin:20px;\">Big Clock</h2>"
-    "<h3 align=\"center\" style=\"color:gray;margin:10px;\">{{DateTime}}</h3>"
-    "<p style=\"text-align:center;\">Reload the page to update the time.</p>"
-    "<p></p><p style=\"padding-top:15px;text-align:center\">" AUTOCONNECT_LINK(COG_24) "</p>"
-    "</body>"
-    "</html>";
-
   char dateTime[32];
 
   if (initialTimeSync) {
-    time_t t = currentTZ.timezone.toLocal(now());
-    sprintf(dateTime, "%02d:%02d:%02d, %s", hour(t), minute(t), second(t), currentTZ.name);
+    time_t t = toLocal(currentTZ, clockNow());
+    snprintf_P(dateTime, sizeof(dateTime), PSTR("%02d:%02d:%02d, %s"), hour(t), minute(t), second(t), currentTZ.name);
   } else {
-    sprintf(dateTime, "Waiting for NTP sync");
+    strlcpy_P(dateTime, PSTR("Waiting for NTP sync"), sizeof(dateTime));
   }
 
-  content.replace("{{DateTime}}", String(dateTime));
-  Server.send(200, "text/html", content);
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "text/html", "");
+  Server.sendContent_P(PORTAL_ROOT_PAGE_HEAD);
+  Server.sendContent(dateTime, strlen(dateTime));
+  Server.sendContent_P(PORTAL_ROOT_PAGE_TAIL);
+  Server.sendContent("");
 }
 
 void portalStartPage() {
   // Retrieve the value of AutoConnectElement with arg function of WebServer class.
   // Values are accessible with the element name.
-  String selectedTimezone = Server.arg("timezone");
-  AutoConnectSelect& timezoneSelector = ConfigureContainer["timezone"].as<AutoConnectSelect>();
-  timezoneSelector.select(selectedTimezone);
-
-  for (uint8_t index = 0; index < sizeof(TZ_LIST) / sizeof(Timezone_t); index++) {
-    String tzName = String(TZ_LIST[index].name);
-    if (selectedTimezone.equalsIgnoreCase(tzName)) {
-      currentTZ = TZ_LIST[index];
-      Serial.println("Selected time Zone: " + String(TZ_LIST[index].name));
-      saveConfig(tzName);
-      break;
-    }
+  const String &selectedTimezone = Server.arg("timezone");
+  Timezone_t zone;
+
+  if (strcasecmp(selectedTimezone.c_str(), currentTZ.name) == 0) {
+    // Unchanged, don't rewrite the config
+  } else if (findTimezone(selectedTimezone.c_str(), zone)) {
+    currentTZ = zone;
+    LOG_INFO("Selected time Zone: %s", currentTZ.name);
+    saveConfig(currentTZ.name);
+  } else {
+    LOG_WARN("Unknown time zone: %s", selectedTimezone.c_str());
   }
+  ConfigureContainer["timezone"].as<AutoConnectInput>().value = currentTZ.name;
 
-  String selectedProgram = Server.arg("program");
+  const String &selectedProgram = Server.arg("program");
   AutoConnectSelect& programSelector = ConfigureContainer["program"].as<AutoConnectSelect>();
   programSelector.select(selectedProgram);
 
   for (size_t program = 0; program < PROGRAM_COUNT; program++) {
-    if (selectedProgram.equals(programNames[program])) {
+    if (strcmp(selectedProgram.c_str(), programNames[program]) == 0) {
       setProgram(program);
       break;
     }
@@ -152,12 +212,114 @@ void portalStartPage() {
 
   // The /start page just constitutes timezone,
   // it redirects to the root page without the content response.
-  Server.sendHeader("Location", String("http://") + Server.client().localIP().toString() + String("/"));
+  char location[24];
+  IPAddress ip = Server.client().localIP();
+  snprintf_P(location, sizeof(location), PSTR("http://%u.%u.%u.%u/"), ip[0], ip[1], ip[2], ip[3]);
+  Server.sendHeader("Location", location);
   Server.send(302, "text/plain", "");
   Server.client().flush();
   Server.client().stop();
 }
 
+/**
+ * @brief Describe what the clock is doing, for the status API and the event stream
+ */
+void fillStatus(JsonDocument &status) {
+  if (initialTimeSync) {
+    char time[9];
+    time_t t = toLocal(currentTZ, clockNow());
+    snprintf_P(time, sizeof(time), PSTR("%02d:%02d:%02d"), hour(t), minute(t), second(t));
+    status["time"] = time;  // copied, the buffer goes out of scope
+    status["epoch"] = clockNow();
+  }
+
+  status["timezone"] = currentTZ.name;
+  status["abbreviation"] = timezoneIsDst(currentTZ, clockNow()) ? currentTZ.dstAbbrev : currentTZ.stdAbbrev;
+  status["program"] = programNames[currentProgram];
+  status["synced"] = initialTimeSync;
+  status["uptime"] = millis() / 1000;
+}
+
+/**
+ * @brief Serve the status as JSON, serialized straight into the socket
+ */
+void portalStatusPage() {
+  StaticJsonDocument<256> status;
+  fillStatus(status);
+
+  Server.setContentLength(measureJson(status));
+  Server.send(200, "application/json", "");
+  serializeJson(status, Server.client());
+}
+
+/**
+ * @brief Hold the connection open as a Server-Sent Events stream that pushEvents() writes to
+ */
+void portalEventsPage() {
+  for (EventClient_t &listener : eventClients) {
+    if (listener.client.connected()) continue;
+
+    // Keep a reference to the connection and write the headers raw, the stream never ends. Writes
+    // go out asynchronously, pushEvents() checks for room first so a slow reader can't block us.
+    listener.client = Server.client();
+    listener.client.setNoDelay(true);
+    listener.client.setSync(false);
+    listener.writableMs = millis();
+    listener.skipped = 0;
+    Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    Server.sendContent_P(PORTAL_EVENTS_HEADER);
+    return;
+  }
+
+  Server.send(503, "text/plain", "Too many event streams");
+}
+
+/**
+ * @brief Send the status to every open event stream, a message of about a hundred bytes each
+ *
+ * Like preview frames, a message the socket has no room for is skipped rather than waited on, and
+ * a stream that takes nothing for EVENTS_STALL_MS is dropped.
+ */
+void pushEvents() {
+  StaticJsonDocument<256> status;
+  char message[192];
+  bool fresh = false;
+  size_t length = 0;
+
+  for (EventClient_t &listener : eventClients) {
+    WiFiClient &client = listener.client;
+    if (!client.connected()) {
+      if (client) client.stop();
+      continue;
+    }
+
+    // Only build the message once there is someone to send it to
+    if (!fresh) {
+      fillStatus(status);
+      length = strlcpy_P(message, PSTR("data: "), sizeof(message));
+      length += serializeJson(status, message + length, sizeof(message) - length - 2);
+      message[length++] = '\n';
+      message[length++] = '\n';
+      fresh = true;
+    }
+
+    if ((size_t) client.availableForWrite() < length) {
+      listener.skipped++;
+      if (millis() - listener.writableMs >= EVENTS_STALL_MS) {
+        LOG_WARN(
+          "Events: stream %u took nothing for %u ms, dropping it", (unsigned) (&listener - eventClients),
+          EVENTS_STALL_MS
+        );
+        client.stop();
+      }
+      continue;
+    }
+    listener.writableMs = millis();
+
+    client.write((const uint8_t *) message, length);
+  }
+}
+
 bool loopCaptivePortal(void) {
   static unsigned long updateTimer = millis();
   static bool tick = true;
@@ -174,20 +336,20 @@ bool loopCaptivePortal(void) {
 }
 
 bool startCaptivePortal(IPAddress& ip) {
-  Serial.println("Portal started, IP: " + WiFi.localIP().toString());
+  LOG_INFO("Portal started, IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
   writeAllDigits(CHAR_DASH, CRGB::Red);
 
   return true;
 }
 
 void onWifiConnect(IPAddress& ipaddr) {
-  Serial.printf("WiiFi connected to %s, IP: %s\n", WiFi.SSID().c_str(), ipaddr.toString().c_str());
+  LOG_INFO("WiiFi connected to %s, IP: %u.%u.%u.%u", WiFi.SSID().c_str(), ipaddr[0], ipaddr[1], ipaddr[2], ipaddr[3]);
   writeAllDigits(CHAR_DASH, CRGB::Green);
 
   if (WiFi.getMode() & WIFI_AP) {
     WiFi.softAPdisconnect(true);
     WiFi.enableAP(false);
-    Serial.printf("SoftAP: %s shut down\n", WiFi.softAPSSID().c_str());
+    LOG_INFO("SoftAP: %s shut down", WiFi.softAPSSID().c_str());
   }
 }
 
@@ -195,449 +357,2636 @@ void onWifiConnect(IPAddress& ipaddr) {
 // =----------------------------------------------------------------------------= NTP and Clock =--=
 
 void setupClock() {
-  timeClient.begin();
-  syncLocalClock();
-}
-
-void loopClock() {
-  static unsigned long updateTimer = 0;
+  clockDiscipline.pollExponent = NTP_POLL_MIN;
 
-  // If the initial time sync failed, keep trying every few seconds until it succeeds
-  if (millis() - updateTimer > (initialTimeSync ? NTP_UPDATE_MS : NTP_RETRY_MS)) {
-    updateTimer = millis();
-    syncLocalClock();
+  // A raw lwIP socket rather than WiFiUDP, so replies are timestamped as they arrive instead of when
+  // the loop gets around to them
+  ntpPcb = udp_new();
+  if (!ntpPcb || udp_bind(ntpPcb, IP_ADDR_ANY, NTP_LOCAL_PORT) != ERR_OK) {
+    LOG_ERROR("NTP: can't open port %u", NTP_LOCAL_PORT);
+    return;
   }
+  udp_recv(ntpPcb, onNtpPacket, nullptr);
 }
 
-void syncLocalClock() {
-  time_t before = now();
+/**
+ * @brief Step the NTP state machine, every step returns without waiting on the network
+ *
+ * Reschedules itself every NTP_POLL_MS while a sync is in progress, and for the next sync, or the
+ * retry if this one failed, when it is done.
+ */
+void loopClock() {
+  uint32_t start = beginStage(PROFILE_NTP, currentProgram);
+  uint32_t next = NTP_POLL_MS;
+
+  if (ntp.state == NTP_IDLE) {
+    startNtpRound();
+  } else if (ntp.state == NTP_RESOLVING) {
+    bool resolved = true;
+    for (NtpServer_t &server : ntpServers) resolved &= server.resolved;
 
-  if (timeClient.update()) {
+    if (resolved || millis() - ntp.phaseStartMs > NTP_TIMEOUT_MS) sendNtpRequests();
+  } else if (ntp.state == NTP_WAITING) {
+    readNtpReplies();
 
-    unsigned long epoch = timeClient.getEpochTime();
-    setTime(epoch);
+    bool answered = true;
+    for (NtpServer_t &server : ntpServers) answered &= server.answered || !server.sent;
 
-    time_t t = currentTZ.timezone.toLocal(epoch);
-    if (initialTimeSync) {
-      // Update over time
-      Serial.printf(
-        "Adjust local clock. Offset is %ld, set to %02d:%02d:%02d\n",
-        (long) epoch - (long) before, hour(t), minute(t), second(t)
-      );
-    } else {
-      initialTimeSync = true;
-      Serial.printf(
-        "Initial time sync. Setting clock to %02d:%02d:%02d\n",
-        hour(t), minute(t), second(t)
-      );
+    if (answered || millis() - ntp.phaseStartMs > NTP_TIMEOUT_MS) {
+      // If the initial time sync failed, keep trying every few seconds until it succeeds
+      next = finishNtpRound() ? 1000UL << clockDiscipline.pollExponent : NTP_RETRY_MS;
     }
-  } else {
-    Serial.println(F("NTP Update Failed"));
   }
-}
 
-// =----------------------------------------------------------------------------------= Display =--=
+  endStage(PROFILE_NTP, currentProgram, start);
+  ntp.tickUs = micros() - start;
+  ntp.tickMaxUs = max(ntp.tickMaxUs, ntp.tickUs);
 
-void clearDisplay() {
-  FastLED.clear();
-  FastLED.show();
+  scheduleTask(TASK_CLOCK, millis() + next);
 }
 
-void setupDisplay() {
-  FastLED.addLeds<NEOPIXEL, LED_PIN>(leds, NUM_LEDS).setCorrection(TypicalLEDStrip);
-  FastLED.setBrightness(LUMINANCE);
-  clearDisplay();
-}
+/**
+ * @brief Local clock in microseconds since 1970
+ */
+uint64_t localEpochUs() {
+  const ClockDiscipline_t &clock = clockDiscipline;
+  int64_t elapsed = micros64() - clock.baseMicros;
+  int64_t slewMax = elapsed * NTP_SLEW_PPM / 1000000;
 
-void loopDisplay(bool first = false) {
-  (*renderFunc[currentProgram])(first);
+  return clock.epochUs + elapsed + elapsed * clock.freqPpb / 1000000000 + constrain(clock.slewUs, -slewMax, slewMax);
 }
 
-void setProgram(uint8_t program) {
-  if (program >= 0 && program < PROGRAM_COUNT && program != currentProgram) {
-    currentProgram = program;
-    Serial.printf("Setting program to %s\n", programNames[program]);
-    loopDisplay(true);
-  }
+/**
+ * @brief Local clock in whole seconds, in place of TimeLib's now() which only counts millis()
+ */
+time_t clockNow() {
+  return localEpochUs() / 1000000;
 }
 
-void surpriseAndDelight() {
-  static unsigned long updateTimer = millis();
-
-  if (millis() - updateTimer > 1000) {
-    updateTimer = millis();
-
-    time_t t = currentTZ.timezone.toLocal(now());
-    if (minute(t) == 0) {
-      // Top o' the hour, let's throw an animation in for a few seconds
-      if (currentProgram == 0 && second(t) < 10) {
-        // We're on the clock, switch to a random one
-        setProgram(random(1, PROGRAM_COUNT - 1));
-      } else if (second(t) > 10) {
-        // Time's up, go back to clock
-        setProgram(0);
-      }
-    }
-  }
+/**
+ * @brief Fold the time since the last rebase into the base, so the rate or slew can change
+ */
+void rebaseClock() {
+  ClockDiscipline_t &clock = clockDiscipline;
+  uint64_t micros = micros64();
+  int64_t elapsed = micros - clock.baseMicros;
+  int64_t slewMax = elapsed * NTP_SLEW_PPM / 1000000;
+  int64_t slewed = constrain(clock.slewUs, -slewMax, slewMax);
+
+  clock.epochUs += elapsed + elapsed * clock.freqPpb / 1000000000 + slewed;
+  clock.slewUs -= slewed;
+  clock.baseMicros = micros;
 }
 
 /**
- * @brief Use the digits to create a progress bar that snakes along the display
+ * @brief Correct the clock by an NTP offset, learning the crystal's frequency error as it goes
  *
- * Serpentine layout starting at upper-left (index 3) across the top, down one segment, back along
- * the middle, down to the bottom and across to the right again.
+ * Small offsets are slewed in at up to NTP_SLEW_PPM so the display never jumps. The part of an
+ * offset that the previous slew wasn't already going to correct is drift since the last sample,
+ * and half of it over that interval goes into the frequency correction. Offsets that stay small
+ * stretch the poll interval a step at a time, a large one brings it back in.
+ *
+ * @param offsetUs Server clock minus local clock.
+ * @return Whether the clock was stepped rather than slewed.
  */
-void writeProgressBar(uint8_t percentage, CRGB color) {
-  static uint8_t lastPercent = 255; // impossible value to force first update
-  if (percentage == lastPercent) return; // Only update if percent changed
-  lastPercent = percentage;
+bool disciplineClock(int64_t offsetUs) {
+  ClockDiscipline_t &clock = clockDiscipline;
+  bool step = !initialTimeSync || llabs(offsetUs) > NTP_STEP_US;
 
-  FastLED.clear();
+  rebaseClock();
 
-  uint8_t totalBars = sizeof(progressSegmentMap)/sizeof(progressSegmentMap[0]);
-  uint8_t numBars = (float)percentage / (100.0 / (float)(totalBars / 2));
-  for (uint8_t bar = 0; bar < numBars; bar++) {
-    writeSegment(progressSegmentMap[bar * 2], progressSegmentMap[bar * 2 + 1], color);
+  if (step) {
+    clock.epochUs += offsetUs;
+    clock.slewUs = 0;
+    clock.pollExponent = NTP_POLL_MIN;
+    clock.stable = 0;
+  } else {
+    if (clock.sampleMicros) {
+      int64_t drift = offsetUs - clock.slewUs;
+      int64_t interval = clock.baseMicros - clock.sampleMicros;
+      int64_t freqPpb = clock.freqPpb + drift * 1000000000 / interval / 2;
+      clock.freqPpb = constrain(freqPpb, -NTP_FREQ_MAX_PPB, NTP_FREQ_MAX_PPB);
+    }
+    clock.slewUs = offsetUs;
+
+    if (llabs(offsetUs) > NTP_POLL_LOOSE_US) {
+      clock.pollExponent = max(clock.pollExponent - 1, NTP_POLL_MIN);
+      clock.stable = 0;
+    } else if (llabs(offsetUs) < NTP_POLL_TIGHT_US && ++clock.stable >= NTP_POLL_STABLE) {
+      clock.pollExponent = min(clock.pollExponent + 1, NTP_POLL_MAX);
+      clock.stable = 0;
+    }
   }
+  clock.sampleMicros = clock.baseMicros;
 
-  FastLED.show();
-  FastLED.delay(1); // Yield to WiFi/OTA stack safely
+  ClockSample_t &sample = clockHistory[clockSamples++ % NTP_HISTORY_SIZE];
+  sample.epoch = clock.epochUs / 1000000;
+  sample.offsetUs = constrain(offsetUs, (int64_t) INT32_MIN, (int64_t) INT32_MAX);
+  sample.freqPpb = clock.freqPpb;
+  sample.pollExponent = clock.pollExponent;
+  sample.stepped = step;
+
+  return step;
 }
 
 /**
- * Write the same character to every digit
+ * @brief Serve the clock discipline state and the sample history as JSON, oldest sample first
  */
-void writeAllDigits(uint8_t character, CRGB color) {
-  int numDigits = sizeof(descriptors) / sizeof(descriptors[0]);
-  for (uint8_t digit = 0; digit < numDigits; digit++) {
-    writeDigit(character, digit, color);
+void portalClockPage() {
+  const ClockDiscipline_t &clock = clockDiscipline;
+  char buffer[256];
+  size_t length = snprintf_P(
+    buffer, sizeof(buffer), PSTR("{\"freqPpb\":%ld,\"slewUs\":%ld,\"pollSeconds\":%lu,\"history\":["),
+    (long) clock.freqPpb, (long) clock.slewUs, 1UL << clock.pollExponent
+  );
+
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "application/json", "");
+
+  uint32_t first = clockSamples > NTP_HISTORY_SIZE ? clockSamples - NTP_HISTORY_SIZE : 0;
+  for (uint32_t n = first; n < clockSamples; n++) {
+    // Flushed while the longest possible entry might not fit, so none is ever cut short
+    if (sizeof(buffer) - length < NTP_HISTORY_ENTRY_SIZE) {
+      Server.sendContent(buffer, length);
+      length = 0;
+    }
+
+    const ClockSample_t &sample = clockHistory[n % NTP_HISTORY_SIZE];
+    length += snprintf_P(
+      buffer + length, sizeof(buffer) - length,
+      PSTR("%s{\"epoch\":%lu,\"offsetUs\":%ld,\"freqPpb\":%ld,\"pollSeconds\":%lu,\"stepped\":%s}"),
+      n > first ? "," : "", sample.epoch, (long) sample.offsetUs, (long) sample.freqPpb,
+      1UL << sample.pollExponent, sample.stepped ? "true" : "false"
+    );
   }
-  FastLED.show();
-  FastLED.delay(1); // Yield to WiFi/OTA stack safely
+
+  if (sizeof(buffer) - length < sizeof("]}")) {
+    Server.sendContent(buffer, length);
+    length = 0;
+  }
+
+  length += strlcpy_P(buffer + length, PSTR("]}"), sizeof(buffer) - length);
+  Server.sendContent(buffer, length);
+  Server.sendContent("");
 }
 
 /**
- * @brief Set the character for a digit.
- *
- * @param character The hex digit value to value to display.
- * @param place The place value (position) to display the digit.
- * @param color The color of the segment to use.
+ * @brief Look up every server, the answers come back through onNtpHostFound()
  */
-void writeDigit(uint8_t character, uint16_t place, CRGB color) {
-  uint8_t segmentMap = font[character];
-  
-  for(uint8_t segment = 0; segment < 7; ++segment) {
-    writeSegment(place, segment, segmentMap & 0x01 ? color : CRGB::Black);
-    segmentMap >>= 1;
+void startNtpRound() {
+  ntp.state = NTP_RESOLVING;
+  ntp.phaseStartMs = millis();
+
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    NtpServer_t &server = ntpServers[n];
+    server.resolved = server.sent = server.answered = server.outlier = false;
+
+    ip_addr_t address;
+    if (dns_gethostbyname(NTP_SERVERS[n], &address, onNtpHostFound, (void *) (uintptr_t) n) == ERR_OK) {
+      server.address = IPAddress(address);
+      server.resolved = true;
+    }
   }
 }
 
+void onNtpHostFound(const char *name, const ip_addr_t *address, void *arg) {
+  NtpServer_t &server = ntpServers[(uintptr_t) arg];
+
+  // Lookups that finish after the round gave up on them are ignored
+  if (ntp.state != NTP_RESOLVING || !address) return;
+
+  server.address = IPAddress(*address);
+  server.resolved = true;
+}
+
 /**
- * @brief A utility function to light an individual segment of one digit
+ * @brief Send a request to every server that resolved
  *
- * @param place The digit to control.
- * @param segment The segment of the digit to light.
- * @param color The color value to which the LEDs will be set.
+ * The transmit timestamp is set to micros64() rather than the time, the server echoes it back as
+ * the originate timestamp and that is all it is used for, telling replies from strays.
  */
-void writeSegment(uint16_t place, uint8_t segment, CRGB color) {
-  uint16_t startingLed = descriptors[place].startingLedNumber;
-  uint8_t ledsPerStrip = descriptors[place].ledsPerStrip;
-  uint8_t numStrips = descriptors[place].numStrips;
+void sendNtpRequests() {
+  uint8_t packet[NTP_PACKET_SIZE];
 
-  for (uint8_t strip = 0; strip < numStrips; ++strip) {
-    uint16_t stripNum = strip % 2 ? (strip + 1) * 7 - 1 - segment : strip * 7 + segment;
-    uint16_t start = startingLed + stripNum * ledsPerStrip;
-    uint16_t last = start + ledsPerStrip;
-    
-    while (start < last) {
-      leds[start] = color;
-      ++start;
-    }
+  ntp.state = NTP_WAITING;
+  ntp.phaseStartMs = millis();
+  ntpReplyCount = 0;
+
+  for (NtpServer_t &server : ntpServers) {
+    if (!server.resolved || !ntpPcb) continue;
+
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0b00100011;     // no leap warning, version 4, client mode
+
+    server.originate = micros64();
+    for (uint8_t n = 0; n < 8; n++) packet[40 + n] = server.originate >> (56 - 8 * n);
+
+    pbuf *buffer = pbuf_alloc(PBUF_TRANSPORT, sizeof(packet), PBUF_RAM);
+    if (!buffer) continue;
+    pbuf_take(buffer, packet, sizeof(packet));
+
+    server.sentUs = localEpochUs();
+    server.sent = udp_sendto(ntpPcb, buffer, server.address, 123) == ERR_OK;
+    pbuf_free(buffer);
   }
 }
 
-uint16_t XY(uint8_t x, uint8_t y) {
-  // any out of bounds address maps to the first hidden pixel
-  if ( (x >= MATRIX_WIDTH) || (y >= MATRIX_HEIGHT) ) {
-    return (LAST_VISIBLE_LED + 1);
+/**
+ * @brief lwIP receive callback, stamps a reply with the local clock and sets it aside
+ *
+ * Runs from the SDK between turns of the loop, as soon as the packet is in, so the receive time
+ * doesn't include however long the loop takes to poll. readNtpReplies() does the rest.
+ */
+void onNtpPacket(void *arg, udp_pcb *pcb, pbuf *p, const ip_addr_t *address, u16_t port) {
+  uint64_t receivedUs = localEpochUs();
+
+  // Anything past one reply per server this round is a stray
+  if (ntp.state == NTP_WAITING && ntpReplyCount < NTP_SERVER_COUNT && p->tot_len >= NTP_PACKET_SIZE) {
+    NtpReply_t &reply = ntpReplies[ntpReplyCount++];
+    pbuf_copy_partial(p, reply.packet, NTP_PACKET_SIZE, 0);
+    reply.from = IPAddress(address);
+    reply.receivedUs = receivedUs;
   }
 
-  return XYTable[(y * MATRIX_WIDTH) + x];
+  pbuf_free(p);
 }
 
-void programClock(bool first) {
-  static unsigned long updateTimer = millis();
-
-  if (first || millis() - updateTimer > CLOCK_UPDATE_MS) {
-    updateTimer = millis();
-
-    if (initialTimeSync) {
-      time_t t = currentTZ.timezone.toLocal(now());
-
-      writeDigit(minute(t) % 10, 0, colorMinute);
-      writeDigit(minute(t) / 10, 1, colorMinute);
-      writeDigit(hour(t) % 10, 2, colorHour);
-      writeDigit(hour(t) / 10, 3, colorHour);
+/**
+ * @brief NTP timestamp, seconds since 1900 and a 32 bit fraction, in microseconds since 1970
+ */
+int64_t ntpToEpochUs(const uint8_t *timestamp) {
+  uint32_t seconds = (uint32_t) timestamp[0] << 24 | timestamp[1] << 16 | timestamp[2] << 8 | timestamp[3];
+  uint32_t fraction = (uint32_t) timestamp[4] << 24 | timestamp[5] << 16 | timestamp[6] << 8 | timestamp[7];
 
-      if (second(t) % 2) {
-        leds[colon1] = colorColon;
-        leds[colon2] = colorColon;
-      } else {
-        leds[colon1] = CRGB::Black;
-        leds[colon2] = CRGB::Black;
-      }
+  return (int64_t) (seconds - NTP_UNIX_EPOCH) * 1000000 + (((uint64_t) fraction * 1000000) >> 32);
+}
 
-      FastLED.show();  // Flush the settings to the LEDs
+/**
+ * @brief Take whatever replies onNtpPacket() has set aside, without waiting for more
+ */
+void readNtpReplies() {
+  for (uint8_t r = 0; r < ntpReplyCount; r++) {
+    const uint8_t *packet = ntpReplies[r].packet;
+    const IPAddress &from = ntpReplies[r].from;
+    uint64_t receivedUs = ntpReplies[r].receivedUs;
+
+    uint64_t originate = 0;
+    for (uint8_t n = 0; n < 8; n++) originate = originate << 8 | packet[24 + n];
+
+    for (NtpServer_t &server : ntpServers) {
+      if (!server.sent || server.answered || !(server.address == from) || server.originate != originate) continue;
+
+      // Server mode, a stratum that says it is synchronized, and no alarm in the leap bits
+      uint8_t stratum = packet[1];
+      if ((packet[0] & 0x07) != 4 || stratum == 0 || stratum > 15 || (packet[0] >> 6) == 3) break;
+
+      int64_t serverReceived = ntpToEpochUs(packet + 32);
+      int64_t serverSent = ntpToEpochUs(packet + 40);
+
+      server.offsetUs = ((serverReceived - (int64_t) server.sentUs) + (serverSent - (int64_t) receivedUs)) / 2;
+      server.rttUs = (receivedUs - server.sentUs) - (serverSent - serverReceived);
+      server.stratum = stratum;
+      server.answered = true;
+      server.replies++;
+      break;
     }
   }
-}
 
-void programMatrix(bool first) {
-  static unsigned long updateTimer = millis();
+  ntpReplyCount = 0;
+}
 
-  if (first || millis() - updateTimer > ANIMATION_UPDATE_MS) {
-    updateTimer = millis();
-
-    // Move code downward
-    // Start with lowest row to allow proper overlapping on each column
-    for (int8_t row = MATRIX_HEIGHT - 1; row >= 0; row--) {
-      for (int8_t col = 0; col < MATRIX_WIDTH; col++) {
-        if (leds[XY(col, row)] == CRGB(175, 255, 175)) {
-          leds[XY(col, row)] = CRGB(27, 130, 39); // create trail
-          if (row < MATRIX_HEIGHT - 1) leds[XY(col, row + 1)] = CRGB(175, 255, 175);
-        }
-      }
-    }
+/**
+ * @brief Pick the best reply and set the clock from it
+ *
+ * Replies further than NTP_OUTLIER_US from the median offset are discarded as a server that is
+ * wrong or a reply delayed on one leg only. Of the rest, the one with the shortest round trip wins,
+ * its offset has the least room for path asymmetry.
+ *
+ * @return Whether the clock was set.
+ */
+bool finishNtpRound() {
+  int64_t offsets[NTP_SERVER_COUNT];
+  uint8_t count = 0;
 
-    // fade all leds
-    for(int i = 0; i < NUM_LEDS; i++) {
-      if (leds[i].g != 255) leds[i].nscale8(192); // only fade trail
-    }
+  ntp.state = NTP_IDLE;
+  ntp.rounds++;
 
-    // check for empty screen to ensure code spawn
-    bool emptyScreen = true;
-    for(int i = 0; i < NUM_LEDS; i++) {
-      if (leds[i]) {
-        emptyScreen = false;
-        break;
-      }
-    }
+  for (NtpServer_t &server : ntpServers) {
+    if (server.sent && !server.answered) server.timeouts++;
+    if (!server.answered) continue;
 
-    // spawn new falling code
-    if (random8(3) == 0 || emptyScreen) { // lower number == more frequent spawns
-      int8_t spawnX = random8(MATRIX_WIDTH);
-      leds[XY(spawnX, 0)] = CRGB(175, 255, 175);
-    }
+    // Insertion sort, there are only a handful
+    uint8_t n = count++;
+    for (; n > 0 && offsets[n - 1] > server.offsetUs; n--) offsets[n] = offsets[n - 1];
+    offsets[n] = server.offsetUs;
+  }
 
-    FastLED.show();
+  if (!count) {
+    ntp.failures++;
+    LOG_WARN("NTP Update Failed");
+    return false;
   }
-}
 
-void programRainbow(bool first) {
-  static unsigned long updateTimer = millis();
+  int64_t median = offsets[count / 2];
+  NtpServer_t *best = nullptr;
 
-  if (first || millis() - updateTimer > ANIMATION_UPDATE_MS) {
-    updateTimer = millis();
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    NtpServer_t &server = ntpServers[n];
+    if (!server.answered) continue;
 
-    int32_t yHueDelta32 = ((int32_t) cos16(updateTimer * (27 / 3)) * (350 / MATRIX_WIDTH));
-    int32_t xHueDelta32 = ((int32_t) cos16(updateTimer * (39 / 3)) * (310 / MATRIX_HEIGHT));
+    server.outlier = llabs(server.offsetUs - median) > NTP_OUTLIER_US;
+    if (!server.outlier && (!best || server.rttUs < best->rttUs)) best = &server;
 
-    byte startHue8 = updateTimer / 65536;
-    int8_t yHueDelta8 = yHueDelta32 / 32768;
-    int8_t xHueDelta8 = xHueDelta32 / 32768;
+    LOG_DEBUG(
+      "NTP %s: offset %s%lu.%03lu s, rtt %lu us, stratum %u%s", NTP_SERVERS[n], server.offsetUs < 0 ? "-" : "",
+      (uint32_t) (llabs(server.offsetUs) / 1000000), (uint32_t) (llabs(server.offsetUs) / 1000 % 1000),
+      server.rttUs, server.stratum, server.outlier ? ", outlier" : ""
+    );
+  }
 
-    byte lineStartHue = startHue8;
-    for (byte y = 0; y < MATRIX_HEIGHT; y++) {
-      lineStartHue += yHueDelta8;
-      byte pixelHue = lineStartHue;
-      for (byte x = 0; x < MATRIX_WIDTH; x++) {
-        pixelHue += xHueDelta8;
-        leds[XY(x, y)] = CHSV(pixelHue, 255, 255);
-      }
-    }
+  bool stepped = disciplineClock(best->offsetUs);
 
-    FastLED.show();
+  time_t t = toLocal(currentTZ, clockNow());
+  if (initialTimeSync) {
+    // Update over time
+    LOG_INFO(
+      "%s local clock. Offset is %ld ms, drift %ld ppb, next sync in %lu s, NTP step took at most %lu us",
+      stepped ? "Stepped" : "Slewing", (long) (best->offsetUs / 1000), (long) clockDiscipline.freqPpb,
+      1UL << clockDiscipline.pollExponent, ntp.tickMaxUs
+    );
+  } else {
+    initialTimeSync = true;
+    LOG_INFO(
+      "Initial time sync. Setting clock to %02d:%02d:%02d",
+      hour(t), minute(t), second(t)
+    );
   }
-}
 
-void programFire(bool first) {
-  static unsigned long updateTimer = millis();
-  if (first) currentPalette = HeatColors_p;
+  return true;
+}
 
-  if (first || millis() - updateTimer > ANIMATION_UPDATE_MS) {
-    updateTimer = millis();
+// =----------------------------------------------------------------------------------= Display =--=
 
-    for (int i = 0; i < MATRIX_WIDTH; i++) {
-      for (int j = 0; j < MATRIX_HEIGHT; j++) {
-        leds[XY(i, j)] = ColorFromPalette(currentPalette, qsub8(inoise8(i * 60, j * 60 + updateTimer, updateTimer / 3),
-        abs8(j - (MATRIX_HEIGHT - 1)) * 255 / (MATRIX_HEIGHT - 1)), 255);
-      }
-    }
-    FastLED.show();
+/**
+ * @brief Run a shader over the matrix cells that have an LED
+ *
+ * For effects that compute each pixel on its own this skips the padding cells, more than half the
+ * matrix, that never reach the chain. Effects that read their neighbours still need XY().
+ *
+ * @param shader Called with the x, y and LED address of every visible pixel.
+ */
+template <typename Shader>
+inline void forEachVisiblePixel(Shader shader) {
+  for (uint16_t n = 0; n < NUM_PHYSICAL_LEDS; n++) {
+    uint32_t pixel = pgm_read_dword(&PanelLayout.pixels[n]);
+    shader((uint8_t) pixel, (uint8_t) (pixel >> 8), (uint16_t) (pixel >> 16));
   }
 }
 
-uint16_t _plasmaShift = (random8(0, 5) * 32) + 64;
-uint16_t _plasmaTime = 0;
-const uint8_t _plasmaXfactor = 8;
-const uint8_t _plasmaYfactor = 8;
-void programPlasma(bool first) {
-  static unsigned long updateTimer = millis();
+void clearLeds() {
+  memset(drawMatrix->buffer, 0, drawMatrix->indexed ? MATRIX_INDEXED_BYTES : MATRIX_COLOR_BYTES);
+  invalidateDigits();
+}
 
-  if (first || millis() - updateTimer > ANIMATION_UPDATE_MS) {
-    updateTimer = millis();
+void clearDisplay() {
+  finishTransition();
+  setDisplayIndexed(false);
+  clearLeds();
+  showDisplay(true);
+}
 
-    for (int16_t x = 0; x < MATRIX_WIDTH; x++) {
-      for (int16_t y = 0; y < MATRIX_HEIGHT; y++) {
-        int16_t r = sin16(_plasmaTime) / 256;
-        int16_t h = sin16(x * r * _plasmaXfactor + _plasmaTime) + cos16(y * (-r) * _plasmaYfactor + _plasmaTime) + sin16(y * x * (cos16(-_plasmaTime) / 256) / 2);
-        leds[XY(x, y)] = CHSV((uint8_t)((h / 256) + 128), 255, 255);
-      }
-    }
-    uint16_t oldPlasmaTime = _plasmaTime;
-    _plasmaTime += _plasmaShift;
-    if (oldPlasmaTime > _plasmaTime)
-    _plasmaShift = (random8(0, 5) * 32) + 64;
+/**
+ * @brief Point `leds` and `indexedLeds` at one of the two matrices
+ */
+void selectMatrix(uint8_t matrix) {
+  drawMatrix = &matrices[matrix];
+  leds = (CRGB *) drawMatrix->buffer;
+  indexedLeds = drawMatrix->buffer;
+}
 
-    FastLED.show();
+/**
+ * @brief Give a matrix the storage its contents need in matrixPool
+ *
+ * Matrix 0 sits at the start of the pool and matrix 1 at the end, so they only collide when both
+ * hold a full color matrix. Indexed programs take a byte per pixel instead of three. The outgoing
+ * side of a transition between two color programs is frozen to its wired LEDs to make room, and
+ * between two indexed programs to leave paletteLut to the incoming one. A frozen matrix keeps the
+ * start of its last frame as colors, anything else starts out cleared.
+ *
+ * @param matrix Which matrix.
+ * @param indexed Whether it holds palette indices rather than colors.
+ * @param frozen Keep only the wired LEDs of its last frame, the matrix is no longer drawn into.
+ */
+void placeMatrix(uint8_t matrix, bool indexed, bool frozen) {
+  Matrix_t &placed = matrices[matrix];
+  uint16_t size = frozen ? MATRIX_FROZEN_BYTES : indexed ? MATRIX_INDEXED_BYTES : MATRIX_COLOR_BYTES;
+  uint8_t *buffer = matrix == 0 ? matrixPool : matrixPool + ((MATRIX_POOL_SIZE - size) & ~3);
+
+  if (frozen && placed.indexed && !placed.frozen) {
+    // The colors overlap the indices they come from, so take a copy of the wired ones first
+    uint8_t indices[NUM_PHYSICAL_LEDS];
+    memcpy(indices, placed.buffer, sizeof(indices));
+    for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) {
+      ((CRGB *) buffer)[led] = paletteLut[(uint8_t) (indices[led] + placed.rotation)];
+    }
+  } else if (frozen) {
+    memmove(buffer, placed.buffer, size);
+  } else {
+    memset(buffer, 0, size);
+    placed.rotation = 0;
   }
+
+  placed.buffer = buffer;
+  placed.indexed = indexed;
+  placed.frozen = frozen;
+  if (&placed == drawMatrix) selectMatrix(matrix);
 }
 
+/**
+ * @brief Switch `leds` between holding colors and holding palette indices
+ *
+ * Switching clears the matrix and resets the palette rotation, and ends any transition since the
+ * matrix may grow into the outgoing one. loopDisplay() restarts the running program if something
+ * else switched the mode under it.
+ *
+ * @param indexed Whether programs will write palette indices into indexedLeds.
+ */
+void setDisplayIndexed(bool indexed) {
+  if (indexed == drawMatrix->indexed) return;
 
-// =-------------------------------------------------------------------------------= Filesystem =--=
+  finishTransition();
+  placeMatrix(drawMatrix - matrices, indexed);
+  invalidateDigits();
+}
 
-void setupFilesystem() {
-  loadConfig();
+/**
+ * @brief Copy the wired portion of a matrix into an output buffer as colors
+ *
+ * @param matrix The matrix to read, expanded through paletteLut if indexed.
+ * @param out NUM_PHYSICAL_LEDS colors.
+ */
+void resolveMatrix(const Matrix_t *matrix, CRGB *out) {
+  if (matrix->indexed && !matrix->frozen) {
+    for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) {
+      out[led] = paletteLut[(uint8_t) (matrix->buffer[led] + matrix->rotation)];
+    }
+  } else {
+    memcpy(out, matrix->buffer, MATRIX_FROZEN_BYTES);
+  }
 }
 
-void loadConfig() {
-  if (!LittleFS.begin()) {
-    Serial.println(F("Failed to mount FS"));
-    return;
+/**
+ * @brief Blend two byte buffers, four channels per 32-bit operation
+ *
+ * Even and odd bytes are split into 16-bit lanes so each multiply weights two channels at once
+ * without carrying into its neighbour. All buffers must be 4-byte aligned and may overlap exactly.
+ *
+ * @param out Receives the blend.
+ * @param from Bytes at amount 0.
+ * @param to Bytes at amount 256.
+ * @param count Number of bytes.
+ * @param amount Weight of `to`, 0-256.
+ */
+void blendBytes(uint8_t *out, const uint8_t *from, const uint8_t *to, uint16_t count, uint16_t amount) {
+  uint32_t keep = 256 - amount;
+  uint16_t words = count / 4;
+
+  for (uint16_t n = 0; n < words; n++) {
+    uint32_t a = ((const swar32_t *) from)[n];
+    uint32_t b = ((const swar32_t *) to)[n];
+    uint32_t even = ((a & 0x00FF00FF) * keep + (b & 0x00FF00FF) * amount) >> 8;
+    uint32_t odd = ((a >> 8) & 0x00FF00FF) * keep + ((b >> 8) & 0x00FF00FF) * amount;
+    ((swar32_t *) out)[n] = (even & 0x00FF00FF) | (odd & 0xFF00FF00);
   }
 
-  if (!LittleFS.exists(CONFIG_FILE)) {
-    Serial.println(F("Config file doesn't exist."));
-    return;
+  for (uint16_t n = words * 4; n < count; n++) {
+    out[n] = (from[n] * keep + to[n] * amount) >> 8;
   }
+}
 
-  File configFile = LittleFS.open(CONFIG_FILE, "r");
+/**
+ * @brief Present a frame mixing the outgoing and incoming programs
+ *
+ * Both matrices are resolved to colors for the wired LEDs and combined according to the style and
+ * how far through the transition we are. Ends the transition once its time is up.
+ */
+void presentTransition() {
+  uint32_t elapsed = millis() - transition.startMs;
 
-  if (!configFile) {
-    Serial.println(F("Failed to open config file for reading"));
+  if (elapsed >= transition.durationMs) {
+    finishTransition();
+    showDisplay(true);
     return;
   }
 
-  StaticJsonDocument<512> doc;
-  DeserializationError error = deserializeJson(doc, configFile);
+  uint16_t amount = elapsed * 256 / transition.durationMs;
+  resolveMatrix(&matrices[transition.fromMatrix], transitionFrame);
+  resolveMatrix(drawMatrix, frame);
 
-  if (error) {
-    Serial.println(F("Failed to read config file"));
+  if (transition.style == TRANSITION_WIPE) {
+    uint8_t edge = amount * MATRIX_WIDTH / 256;
+    forEachVisiblePixel([&](uint8_t x, uint8_t y, uint16_t led) {
+      if (x >= edge) frame[led] = transitionFrame[led];
+    });
+  } else {
+    blendBytes((uint8_t *) frame, (uint8_t *) transitionFrame, (uint8_t *) frame, sizeof(frame), amount);
   }
 
-  String tz = doc["timezone"] | String(TZ_LIST[0].name);
+  writeOutput();
+}
 
-  for (uint8_t n = 0; n < sizeof(TZ_LIST) / sizeof(Timezone_t); n++) {
-    String tzName = String(TZ_LIST[n].name);
-    if (tz.equalsIgnoreCase(tzName)) {
-      currentTZ = TZ_LIST[n];
-      Serial.println("Loaded time zone: " + tz);
-      break;
+/**
+ * @brief Drop the outgoing program and leave the incoming one on the display
+ */
+void finishTransition() {
+  transition.active = false;
+}
+
+/**
+ * @brief Build the output lookup table for a brightness
+ *
+ * Folds brightness, per-channel gamma and the white balance into one 8.8 fixed point table per
+ * channel, so writeOutput() needs a single lookup per channel and keeps the fraction for dithering.
+ *
+ * @param brightness Overall brightness, 0-255.
+ */
+void setDisplayBrightness(uint8_t brightness) {
+  const float gamma[] = { DISPLAY_GAMMA_RED, DISPLAY_GAMMA_GREEN, DISPLAY_GAMMA_BLUE };
+  const CRGB balance = DISPLAY_WHITE_BALANCE;
+
+  for (uint8_t channel = 0; channel < 3; channel++) {
+    float scale = brightness * balance.raw[channel] / 255.0f;
+    for (uint16_t value = 0; value < 256; value++) {
+      outputLut[channel][value] = powf(value / 255.0f, gamma[channel]) * scale * 256.0f;
     }
   }
-
-  configFile.close();
-  LittleFS.end();
 }
 
-void saveConfig(String timezone) {
-  if (!LittleFS.begin()) {
-    Serial.println(F("Failed to mount FS"));
-    return;
+/**
+ * @brief Map the presented frame through the output table and clock it out
+ *
+ * One pass over the wired LEDs. The fraction each channel loses to 8 bits is dithered against a
+ * threshold that steps once per frame written and is staggered between neighbouring LEDs, so dim
+ * colors average out to the right hue instead of collapsing onto a few levels. Unchanged frames
+ * aren't written, so a still frame holds its pattern unless DITHER_REFRESH_MS re-sends it.
+ */
+void writeOutput() {
+  static const uint8_t threshold[] = { 0, 128, 64, 192, 32, 160, 96, 224 };
+  uint32_t start = micros();
+  uint8_t phase = ditherFrame++;
+#if DITHER_REFRESH_MS
+  bool dim = false;
+#endif
+
+  for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) {
+    uint8_t dither = threshold[(phase + led) & 7];
+    for (uint8_t channel = 0; channel < 3; channel++) {
+      uint16_t level = outputLut[channel][frame[led].raw[channel]];
+      outputLeds[led].raw[channel] = (level + dither) >> 8;
+#if DITHER_REFRESH_MS
+      dim |= (level & 0xFF) && level < (DITHER_VISIBLE_LEVELS << 8);
+#endif
+    }
   }
+#if DITHER_REFRESH_MS
+  ditherActive = dim;
+  ditherWrittenMs = millis();
+#endif
 
-  File configFile = LittleFS.open(CONFIG_FILE, "w");
+  displayStats.outputUs = micros() - start;
+  displayStats.outputMaxUs = max(displayStats.outputMaxUs, displayStats.outputUs);
 
-  if (!configFile) {
-    Serial.println(F("Failed to open config file for writing"));
-    return;
-  }
+  start = beginStage(PROFILE_SHOW, currentProgram);
+  FastLED.show();
+  endStage(PROFILE_SHOW, currentProgram, start);
 
-  StaticJsonDocument<512> doc;
-  doc["timezone"] = timezone;
+  displayStats.framesPresented++;
+  displayStats.wireTimeSavedUs += DISPLAY_WIRE_SAVED_US;
+}
+
+/**
+ * @brief Push the wired portion of the matrix out to the LED chain
+ *
+ * Programs draw into the full virtual matrix so they have neighbours to work with, but only the
+ * first NUM_PHYSICAL_LEDS addresses exist on the data line. Those are compared against a shadow of
+ * the last frame presented, and only copied and clocked out when something changed. Skipping the
+ * show also skips the interrupt-off transfer that starves the WiFi stack.
+ *
+ * @param force Send the frame even if it matches the last one, e.g. to overwrite power-on garbage.
+ */
+void showDisplay(bool force) {
+  bool changed = force;
+
+  // Programs keep drawing during a transition, but presentTransition() owns the chain
+  if (transition.active) return;
+
+  if (drawMatrix->indexed) {
+    // Palette programs are expanded to colors here, once per wired LED
+    for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) {
+      const CRGB &color = paletteLut[(uint8_t) (indexedLeds[led] + drawMatrix->rotation)];
+      if (frame[led] != color) {
+        frame[led] = color;
+        changed = true;
+      }
+    }
+  } else if (changed || memcmp(frame, leds, sizeof(frame)) != 0) {
+    memcpy(frame, leds, sizeof(frame));
+    changed = true;
+  }
+
+#if DITHER_REFRESH_MS
+  // An unchanged frame only goes out again to move the dither on
+  if (!changed && ditherActive && millis() - ditherWrittenMs >= DITHER_REFRESH_MS) {
+    displayStats.framesDithered++;
+    displayStats.ditherWireUs += NUM_PHYSICAL_LEDS * WS2812_US_PER_LED;
+    changed = true;
+  }
+#endif
+
+  if (!changed) {
+    displayStats.framesSkipped++;
+    displayStats.wireTimeSavedUs += NUM_LEDS * WS2812_US_PER_LED;
+    return;
+  }
+
+  writeOutput();
+}
+
+void setupDisplay() {
+  // Brightness, color correction and dithering all happen in writeOutput()
+  FastLED.addLeds<NEOPIXEL, LED_PIN>(outputLeds, NUM_PHYSICAL_LEDS);
+  FastLED.setDither(DISABLE_DITHER);
+  setDisplayBrightness(LUMINANCE);
+  placeMatrix(1, true);
+  placeMatrix(0, false);
+  clearDisplay();
+
+  LOG_INFO(
+    "Display: %u of %u LEDs wired, %u us wire time saved per frame",
+    NUM_PHYSICAL_LEDS, NUM_LEDS, DISPLAY_WIRE_SAVED_US
+  );
+}
+
+/**
+ * @brief Advance a matrix's frame timing and render its program into it
+ */
+void renderProgram(uint8_t program, bool first, uint32_t now) {
+  FrameContext_t &context = drawMatrix->context;
+
+  context.elapsedMs = first ? 0 : now - context.nowMs;
+  context.index = first ? 0 : context.index + 1;
+  context.nowMs = now;
+  context.first = first;
+
+  uint32_t start = beginStage(PROFILE_RENDER, program);
+  (*renderFunc[program])(context);
+  endStage(PROFILE_RENDER, program, start);
+  recordProfile(renderProfile[program], start);
+}
+
+/**
+ * @brief The frame clock, renders and presents a frame whenever one is due
+ *
+ * Deadlines advance by whole periods from the previous deadline rather than from when the frame
+ * actually ran, so loop latency doesn't accumulate into a lower frame rate. A frame starting more
+ * than a period late is counted and the schedule restarts from now instead of bursting to catch up.
+ *
+ * @param first Start the current program over and render it immediately.
+ */
+void loopDisplay(bool first = false) {
+  uint32_t now = millis();
+
+  if (programIndexed[currentProgram] != drawMatrix->indexed) {
+    setDisplayIndexed(programIndexed[currentProgram]);
+    first = true;
+  }
+
+  // Edge aligned programs fall back to a plain period until there is a time to align to
+  bool aligned = programFrameMs[currentProgram] == FRAME_SECOND_EDGE && initialTimeSync && !transition.active;
+  uint32_t period = programFrameMs[currentProgram] == FRAME_SECOND_EDGE ? CLOCK_UPDATE_MS : programFrameMs[currentProgram];
+  if (transition.active) period = min<uint32_t>(period, TRANSITION_UPDATE_MS);
+
+  if (!first && (int32_t) (now - nextFrameMs) < 0) {
+    uint32_t due = nextFrameMs;
+
+#if DITHER_REFRESH_MS
+    // Between frames of a slow program, move the dither pattern on the frame already shown, unless
+    // sending it would hold up the next real frame
+    if (ditherActive && !transition.active && nextFrameMs - now > DISPLAY_SHOW_MS) {
+      if (now - ditherWrittenMs >= DITHER_REFRESH_MS) {
+        displayStats.framesDithered++;
+        displayStats.ditherWireUs += NUM_PHYSICAL_LEDS * WS2812_US_PER_LED;
+        writeOutput();
+      }
+      if ((int32_t) (ditherWrittenMs + DITHER_REFRESH_MS - due) < 0) due = ditherWrittenMs + DITHER_REFRESH_MS;
+    }
+#endif
+
+    scheduleTask(TASK_DISPLAY, due);
+    return;
+  }
+
+  if (aligned) {
+    uint32_t intoSecondUs = localEpochUs() % 1000000;
+
+    // The scheduler runs on millis(), which the disciplined clock drifts and slews against
+    if (!first && intoSecondUs > 1000000 - FRAME_EDGE_GUARD_US) {
+      scheduleTask(TASK_DISPLAY, now + 1);
+      return;
+    }
+
+    if (!first) {
+      frameStats.edgeErrorUs = intoSecondUs;
+      frameStats.edgeErrorMaxUs = max(frameStats.edgeErrorMaxUs, intoSecondUs);
+      recordSample(edgeError, intoSecondUs);
+    }
+
+    // The first millisecond after the next edge
+    nextFrameMs = now + (1000000 - intoSecondUs) / 1000 + 1;
+  } else if (first || now - nextFrameMs >= period) {
+    if (!first) frameStats.lateFrames++;
+    nextFrameMs = now + period;
+  } else {
+    nextFrameMs += period;
+  }
+  scheduleTask(TASK_DISPLAY, nextFrameMs);
+
+  uint32_t start = micros();
+
+  if (transition.active && !matrices[transition.fromMatrix].frozen) {
+    // The outgoing program keeps animating in its own matrix until it has faded out
+    uint8_t incoming = drawMatrix - matrices;
+    selectMatrix(transition.fromMatrix);
+    renderProgram(transition.fromProgram, false, now);
+    selectMatrix(incoming);
+  }
+
+  renderProgram(currentProgram, first, now);
+
+  uint32_t presentStart = beginStage(PROFILE_PRESENT, currentProgram);
+  if (transition.active) {
+    presentTransition();
+  } else {
+    showDisplay();
+  }
+  endStage(PROFILE_PRESENT, currentProgram, presentStart);
+  recordProfile(presentProfile[currentProgram], presentStart);
+
+  frameStats.frames++;
+  frameStats.worstFrameUs = max<uint32_t>(frameStats.worstFrameUs, micros() - start);
+
+  frameStats.windowFrames++;
+  if (now - frameStats.windowStartMs >= FRAME_STATS_WINDOW_MS) {
+    frameStats.achievedFps10 = frameStats.windowFrames * 10000UL / (now - frameStats.windowStartMs);
+    frameStats.windowFrames = 0;
+    frameStats.windowStartMs = now;
+  }
+}
+
+/**
+ * @brief Switch to another program
+ *
+ * Unless cutting straight over, the incoming program starts in the other matrix and is blended in
+ * over TRANSITION_MS while the outgoing one keeps running. Between two color programs, or two
+ * indexed ones, the outgoing one fades out on its last frame instead: there is only room for one
+ * color matrix and one paletteLut.
+ *
+ * @param program Index into renderFunc.
+ * @param style How to get from the current program to the new one.
+ */
+void setProgram(uint8_t program, TransitionStyle_t style) {
+  if (program >= 0 && program < PROGRAM_COUNT && program != currentProgram) {
+    finishTransition();
+
+    if (style != TRANSITION_CUT) {
+      transition.active = true;
+      transition.style = style;
+      transition.fromProgram = currentProgram;
+      transition.fromMatrix = drawMatrix - matrices;
+      transition.startMs = millis();
+      transition.durationMs = TRANSITION_MS;
+
+      // Two color matrices don't fit side by side and two indexed ones would share paletteLut, the
+      // outgoing one holds its last frame instead
+      if (drawMatrix->indexed == programIndexed[program]) placeMatrix(transition.fromMatrix, false, true);
+      placeMatrix(1 - transition.fromMatrix, programIndexed[program]);
+      selectMatrix(1 - transition.fromMatrix);
+    }
+
+    LOG_DEBUG(
+      "Frames: %s at %u.%u fps, %lu late, worst %lu us", programNames[currentProgram],
+      frameStats.achievedFps10 / 10, frameStats.achievedFps10 % 10, frameStats.lateFrames, frameStats.worstFrameUs
+    );
+    if (programFrameMs[currentProgram] == FRAME_SECOND_EDGE) {
+      LOG_DEBUG("Frames: second edges hit within %lu us", frameStats.edgeErrorMaxUs);
+    }
+    frameStats.lateFrames = 0;
+    frameStats.worstFrameUs = 0;
+    frameStats.edgeErrorMaxUs = 0;
+
+    if (currentProgram == PROGRAM_STREAM) stopStream();
+
+    currentProgram = program;
+    LOG_INFO("Setting program to %s", programNames[program]);
+    loopDisplay(true);
+  }
+}
+
+void surpriseAndDelight() {
+  // Never interrupt a show controller
+  if (currentProgram == PROGRAM_STREAM) return;
+
+  time_t t = toLocal(currentTZ, clockNow());
+  if (minute(t) == 0) {
+    // Top o' the hour, let's throw an animation in for a few seconds
+    if (currentProgram == 0 && second(t) < 10) {
+      // We're on the clock, switch to a random one
+      setProgram(random(1, PROGRAM_STREAM), TRANSITION_WIPE);
+    } else if (second(t) > 10) {
+      // Time's up, go back to clock
+      setProgram(0);
+    }
+  }
+}
+
+/**
+ * @brief Use the digits to create a progress bar that snakes along the display
+ *
+ * Serpentine layout starting at upper-left (index 3) across the top, down one segment, back along
+ * the middle, down to the bottom and across to the right again.
+ */
+void writeProgressBar(uint8_t percentage, CRGB color) {
+  static uint8_t lastPercent = 255; // impossible value to force first update
+  if (percentage == lastPercent) return; // Only update if percent changed
+  lastPercent = percentage;
+
+  finishTransition();
+  setDisplayIndexed(false);
+  clearLeds();
+
+  uint8_t totalBars = sizeof(progressSegmentMap)/sizeof(progressSegmentMap[0]);
+  uint8_t numBars = (float)percentage / (100.0 / (float)(totalBars / 2));
+  for (uint8_t bar = 0; bar < numBars; bar++) {
+    writeSegment(progressSegmentMap[bar * 2], progressSegmentMap[bar * 2 + 1], color);
+  }
+
+  showDisplay();
+  delay(1); // Yield to WiFi/OTA stack safely
+}
+
+/**
+ * Write the same character to every digit
+ */
+void writeAllDigits(uint8_t character, CRGB color) {
+  finishTransition();
+  setDisplayIndexed(false);
+  for (uint8_t digit = 0; digit < DIGIT_COUNT; digit++) {
+    writeDigit(character, digit, color);
+  }
+  showDisplay();
+  delay(1); // Yield to WiFi/OTA stack safely
+}
+
+/**
+ * Forget what the digits show, forcing the next write of each to redraw every segment. Anything
+ * that draws into `leds` without going through writeDigit() needs to call this.
+ */
+void invalidateDigits() {
+  for (uint8_t place = 0; place < DIGIT_COUNT; place++) {
+    digitState[place].valid = false;
+  }
+}
+
+/**
+ * @brief Set the character for a digit.
+ *
+ * Only segments that switch on or off, or change color while lit, are rewritten.
+ *
+ * @param character The hex digit value to value to display.
+ * @param place The place value (position) to display the digit.
+ * @param color The color of the segment to use.
+ * @return The number of LEDs written.
+ */
+uint16_t writeDigit(uint8_t character, uint16_t place, CRGB color) {
+  DigitState_t &state = digitState[place];
+  uint8_t segmentMap = font[character];
+  uint8_t changed = 0x7F;
+
+  if (state.valid) {
+    changed = segmentMap ^ state.segments;
+    if (color != state.color) changed |= segmentMap;
+  }
+
+  uint16_t touched = 0;
+  for (uint8_t segment = 0; changed; ++segment, changed >>= 1) {
+    if (changed & 0x01) {
+      touched += writeSegment(place, segment, (segmentMap >> segment) & 0x01 ? color : CRGB::Black);
+    }
+  }
+
+  state.valid = true;
+  state.segments = segmentMap;
+  state.color = color;
+  return touched;
+}
+
+/**
+ * @brief A utility function to light an individual segment of one digit
+ *
+ * @param place The digit to control.
+ * @param segment The segment of the digit to light.
+ * @param color The color value to which the LEDs will be set.
+ */
+uint16_t writeSegment(uint16_t place, uint8_t segment, CRGB color) {
+  uint16_t touched = 0;
+
+  for (uint8_t strip = 0; strip < SEGMENT_STRIPS; ++strip) {
+    const LedSpan_t *span = &PanelLayout.segments[place][segment][strip];
+    uint16_t length = pgm_read_word(&span->length);
+    fill_solid(&leds[pgm_read_word(&span->start)], length, color);
+    touched += length;
+  }
+
+  return touched;
+}
+
+uint16_t XY(uint8_t x, uint8_t y) {
+  // any out of bounds address maps to the first hidden pixel
+  if ( (x >= MATRIX_WIDTH) || (y >= MATRIX_HEIGHT) ) {
+    return (LAST_VISIBLE_LED + 1);
+  }
+
+  return pgm_read_word(&PanelLayout.xy[(y * MATRIX_WIDTH) + x]);
+}
+
+/**
+ * @brief Fill the visible pixels with a straight gradient of palette indices
+ *
+ * The palette index steps by a fixed amount per column and per row, so the offsets are tabled once
+ * and each pixel is two adds and a lookup.
+ *
+ * @param startIndex Palette index at the top-left cell.
+ * @param xDelta Index step per column, wraps around the palette.
+ * @param yDelta Index step per row.
+ */
+void fillLinearGradient(uint8_t startIndex, int8_t xDelta, int8_t yDelta) {
+  uint8_t columnIndex[MATRIX_WIDTH];
+  uint8_t rowIndex[MATRIX_HEIGHT];
+
+  for (uint8_t x = 0, index = 0; x < MATRIX_WIDTH; x++, index += xDelta) columnIndex[x] = index;
+  for (uint8_t y = 0, index = startIndex; y < MATRIX_HEIGHT; y++, index += yDelta) rowIndex[y] = index;
+
+  forEachVisiblePixel([&](uint8_t x, uint8_t y, uint16_t led) {
+    indexedLeds[led] = rowIndex[y] + columnIndex[x];
+  });
+}
+
+/**
+ * @brief Fill the visible pixels with rings of palette indices around a point
+ *
+ * @param startIndex Palette index at the center.
+ * @param centerX Column of the center, inside the matrix.
+ * @param centerY Row of the center.
+ * @param ringDelta Index step per pixel of distance from the center.
+ */
+void fillRadialGradient(uint8_t startIndex, uint8_t centerX, uint8_t centerY, int8_t ringDelta) {
+  forEachVisiblePixel([&](uint8_t x, uint8_t y, uint16_t led) {
+    int16_t dx = x - centerX, dy = y - centerY;
+    uint16_t distance = sqrt16((dx * dx + dy * dy) << 4); // quarter pixels
+    indexedLeds[led] = startIndex + distance * ringDelta / 4;
+  });
+}
+
+void programClock(const FrameContext_t &context) {
+  // Other programs have drawn over the digits since we last ran
+  if (context.first) invalidateDigits();
+
+  if (initialTimeSync) {
+    time_t t = toLocal(currentTZ, clockNow());
+    uint8_t place = 0;
+    uint16_t touched = 0;
+
+    // Panels with six digits show seconds in the rightmost pair
+    if (DIGIT_COUNT >= 6) {
+      touched += writeDigit(second(t) % 10, place++, colorSecond);
+      touched += writeDigit(second(t) / 10, place++, colorSecond);
+    }
+
+    touched += writeDigit(minute(t) % 10, place++, colorMinute);
+    touched += writeDigit(minute(t) / 10, place++, colorMinute);
+    touched += writeDigit(hour(t) % 10, place++, colorHour);
+    touched += writeDigit(hour(t) / 10, place++, colorHour);
+
+    CRGB colon = second(t) % 2 ? CRGB(colorColon) : CRGB(CRGB::Black);
+    for (uint8_t n = 0; n < COLON_COUNT; n++) {
+      leds[pgm_read_word(&PanelLayout.colons[n][0])] = colon;
+      leds[pgm_read_word(&PanelLayout.colons[n][1])] = colon;
+      touched += 2;
+    }
+
+    displayStats.ledsTouched = touched;
+  }
+}
+
+MatrixRain_t rain;
+
+/**
+ * @brief Draw one column of falling code
+ *
+ * Only touches the rows covered by the drop's trail this frame plus the rows it moved through, which
+ * are blanked so the tail it left behind last frame disappears.
+ *
+ * @param column The column to draw.
+ * @param moved How many whole rows the head advanced since the last frame.
+ */
+void drawRainColumn(uint8_t column, uint8_t moved) {
+  int16_t head = rain.head[column] >> 8;
+  uint8_t trail = rain.trail[column];
+  uint8_t level = 255;
+
+  for (int16_t distance = 0; distance <= trail + moved; distance++) {
+    int16_t row = head - distance;
+    if (row < 0) break;
+    if (row >= MATRIX_HEIGHT) continue;
+
+    CRGB &pixel = leds[XY(column, row)];
+    if (distance == 0) {
+      pixel = CRGB(175, 255, 175);
+    } else if (distance <= trail) {
+      pixel = CRGB(27, 130, 39);
+      pixel.nscale8(level);
+      level = scale8(level, 192);
+    } else {
+      pixel = CRGB::Black;
+    }
+  }
+}
+
+void programMatrix(const FrameContext_t &context) {
+  uint32_t elapsed = min<uint32_t>(context.elapsedMs, 1000); // cap after a stall
+
+  if (context.first) {
+    clearLeds();
+    memset(&rain, 0, sizeof(rain));
+  }
+
+  // Move code downward
+  for (uint8_t column = 0; column < MATRIX_WIDTH; column++) {
+    if (!rain.trail[column]) continue;
+
+    uint16_t previous = rain.head[column] >> 8;
+    rain.head[column] += (uint32_t) rain.speed[column] * elapsed / 1000;
+    uint16_t head = rain.head[column] >> 8;
+
+    drawRainColumn(column, head - previous);
+
+    // Retire the drop once its whole trail has fallen off the bottom
+    if (head - rain.trail[column] >= MATRIX_HEIGHT) {
+      rain.trail[column] = 0;
+      rain.drops--;
+    }
+  }
+
+  // Spawn new falling code, always keep at least one drop going
+  if (random16(1000) < RAIN_SPAWNS_PER_SECOND * elapsed || rain.drops == 0) {
+    uint8_t column = random8(MATRIX_WIDTH);
+    if (!rain.trail[column]) {
+      rain.head[column] = 0;
+      rain.speed[column] = random16(RAIN_SPEED_MIN << 8, RAIN_SPEED_MAX << 8);
+      rain.trail[column] = random8(RAIN_TRAIL_MIN, RAIN_TRAIL_MAX + 1);
+      rain.drops++;
+      drawRainColumn(column, 0);
+    }
+  }
+}
+
+/**
+ * @brief Draw one frame of the rainbow into the visible pixels
+ *
+ * A linear gradient of palette indices for the rainbow LUT, with the hue steps along each
+ * axis swinging back and forth over time.
+ *
+ * @param time Animation time in milliseconds.
+ */
+void renderRainbow(uint32_t time) {
+  int32_t yHueDelta32 = ((int32_t) cos16(time * (27 / 3)) * (350 / MATRIX_WIDTH));
+  int32_t xHueDelta32 = ((int32_t) cos16(time * (39 / 3)) * (310 / MATRIX_HEIGHT));
+
+  byte startHue8 = time / 65536;
+  int8_t yHueDelta8 = yHueDelta32 / 32768;
+  int8_t xHueDelta8 = xHueDelta32 / 32768;
+
+  // Hues start one step in, at (1, 1)
+  fillLinearGradient(startHue8 + xHueDelta8 + yHueDelta8, xHueDelta8, yHueDelta8);
+}
+
+void programRainbow(const FrameContext_t &context) {
+  if (context.first) loadRainbowLut();
+  renderRainbow(context.nowMs);
+}
+
+/**
+ * @brief Expand a palette into paletteLut so per-pixel lookups skip ColorFromPalette()
+ */
+void loadPaletteLut(const CRGBPalette16 &palette) {
+  for (uint16_t index = 0; index < 256; index++) {
+    paletteLut[index] = ColorFromPalette(palette, index, 255);
+  }
+}
+
+/**
+ * @brief Fill paletteLut with the full-saturation HSV rainbow so hues skip the CHSV conversion
+ */
+void loadRainbowLut() {
+  for (uint16_t hue = 0; hue < 256; hue++) {
+    paletteLut[hue] = CHSV(hue, 255, 255);
+  }
+}
+
+/**
+ * @brief Draw one frame of fire into the visible pixels
+ *
+ * Perlin noise is only evaluated on a lattice every FIRE_LATTICE_STEP pixels and bilinearly
+ * upsampled in between, which is about a sixth of the inoise8() calls of sampling every cell. The
+ * heat is written as a palette index for the heat palette LUT.
+ *
+ * @param time Animation time in milliseconds, scrolls the noise field up and evolves it.
+ */
+void renderFire(uint32_t time) {
+  const uint8_t step = FIRE_LATTICE_STEP;
+  uint8_t lattice[FIRE_LATTICE_HEIGHT][FIRE_LATTICE_WIDTH];
+
+  for (uint8_t y = 0; y < FIRE_LATTICE_HEIGHT; y++) {
+    for (uint8_t x = 0; x < FIRE_LATTICE_WIDTH; x++) {
+      lattice[y][x] = inoise8(x * step * 60, y * step * 60 + time, time / 3);
+    }
+  }
+
+  forEachVisiblePixel([&](uint8_t x, uint8_t y, uint16_t led) {
+    uint8_t lx = x / step, fx = x % step;
+    uint8_t ly = y / step, fy = y % step;
+
+    uint16_t top = lattice[ly][lx] * (step - fx) + lattice[ly][lx + 1] * fx;
+    uint16_t bottom = lattice[ly + 1][lx] * (step - fx) + lattice[ly + 1][lx + 1] * fx;
+    uint8_t noise = (top * (step - fy) + bottom * fy) / (step * step);
+
+    // Cool off toward the top of the display
+    uint8_t cooling = (MATRIX_HEIGHT - 1 - y) * 255 / (MATRIX_HEIGHT - 1);
+    indexedLeds[led] = qsub8(noise, cooling);
+  });
+}
+
+void programFire(const FrameContext_t &context) {
+  if (context.first) loadPaletteLut(HeatColors_p);
+
+  renderFire(context.nowMs);
+}
+
+uint16_t _plasmaShift = (random8(0, 5) * 32) + 64;
+uint16_t _plasmaTime = 0;
+const uint8_t _plasmaXfactor = 8;
+const uint8_t _plasmaYfactor = 8;
+int16_t sineLut[256];                 // sin16() at 8-bit angle resolution, filled on first use
+
+/**
+ * @brief Draw one frame of plasma into the visible pixels
+ *
+ * The three wave terms are split so only the x*y term depends on both coordinates. The column and
+ * row waves are computed once per frame, the x*y wave comes from sineLut, leaving adds and a lookup
+ * per pixel. Hues are written as palette indices for the rainbow LUT.
+ *
+ * @param time Plasma phase, wraps at 16 bits.
+ */
+void renderPlasma(uint32_t time) {
+  uint16_t t = time;
+  int16_t r = sin16(t) / 256;
+  int16_t c = cos16(-t) / 256;
+  int16_t columnWave[MATRIX_WIDTH];
+  int16_t rowWave[MATRIX_HEIGHT];
+
+  static bool sineLutLoaded = false;
+  if (!sineLutLoaded) {
+    for (uint16_t angle = 0; angle < 256; angle++) sineLut[angle] = sin16(angle << 8);
+    sineLutLoaded = true;
+  }
+
+  for (int16_t x = 0; x < MATRIX_WIDTH; x++) columnWave[x] = sin16(x * r * _plasmaXfactor + t);
+  for (int16_t y = 0; y < MATRIX_HEIGHT; y++) rowWave[y] = cos16(y * (-r) * _plasmaYfactor + t);
+
+  forEachVisiblePixel([&](int16_t x, int16_t y, uint16_t led) {
+    uint16_t angle = y * x * c / 2;
+    int16_t h = columnWave[x] + rowWave[y] + sineLut[(uint8_t) ((angle + 128) >> 8)];
+    indexedLeds[led] = (h / 256) + 128;
+  });
+}
+
+void programPlasma(const FrameContext_t &context) {
+  if (context.first) loadRainbowLut();
+
+  // Advance the phase by time, the shift is per ANIMATION_UPDATE_MS
+  uint32_t phase = _plasmaTime + (uint32_t) _plasmaShift * min<uint32_t>(context.elapsedMs, 1000) / ANIMATION_UPDATE_MS;
+  _plasmaTime = phase;
+  if (phase > 0xFFFF)
+  _plasmaShift = (random8(0, 5) * 32) + 64;
+
+  renderPlasma(_plasmaTime);
+}
+
+uint16_t _rippleCenter = 0xFFFF;       // column and row the rings were last drawn around, none yet
+
+/**
+ * @brief Draw one frame of ripples into the visible pixels
+ *
+ * Rainbow rings spread out from a center that wanders across the panel on a slow Lissajous path,
+ * as a radial gradient of palette indices for the rainbow LUT. The rings move outward by rotating
+ * the palette, so the gradient is only redrawn on frames where the center has moved to another pixel.
+ *
+ * @param time Animation time in milliseconds.
+ */
+void renderRipple(uint32_t time) {
+  uint8_t centerX = scale8(sin8(time / 47), MATRIX_WIDTH - 1);
+  uint8_t centerY = scale8(cos8(time / 71), MATRIX_HEIGHT - 1);
+  uint16_t center = centerX << 8 | centerY;
+
+  // The index at the center falling over time moves every ring outward
+  drawMatrix->rotation = -(time / 8);
+
+  if (center == _rippleCenter) return;
+  _rippleCenter = center;
+  fillRadialGradient(0, centerX, centerY, RIPPLE_RING_DELTA);
+}
+
+void programRipple(const FrameContext_t &context) {
+  if (context.first) {
+    loadRainbowLut();
+    _rippleCenter = 0xFFFF;
+  }
+
+  renderRipple(context.nowMs);
+}
+
+/**
+ * @brief Read one DDP packet from the socket into the slot being assembled
+ *
+ * @param size Size of the packet, from parsePacket().
+ */
+void readStreamPacket(int size) {
+  DdpHeader_t header;
+
+  if (size < (int) sizeof(header) || streamUDP.read((uint8_t *) &header, sizeof(header)) != sizeof(header)) {
+    streamStats.malformed++;
+    return;
+  }
+
+  if ((header.flags & DDP_VERSION_MASK) != DDP_VERSION_1) {
+    streamStats.malformed++;
+    return;
+  }
+
+  // Queries, control and status are for senders that configure their targets, there's nothing to answer
+  if (header.flags & DDP_FLAG_QUERY || header.destination >= DDP_DESTINATION_CONTROL) return;
+
+  if (header.flags & DDP_FLAG_TIMECODE) {
+    uint8_t timecode[4];
+    streamUDP.read(timecode, sizeof(timecode));
+  }
+
+  // Sequence numbers wrap 1-15, anything up to half the range behind the last one is stale
+  uint8_t sequence = header.sequence & 0x0F;
+  if (sequence && stream.lastSequence) {
+    uint8_t ahead = (sequence - stream.lastSequence) & 0x0F;
+    if (ahead == 0) {
+      streamStats.duplicates++;
+      return;
+    }
+    if (ahead > 7) {
+      streamStats.late++;
+      return;
+    }
+  }
+  if (sequence) stream.lastSequence = sequence;
+
+  uint32_t offset = (uint32_t) header.offset[0] << 24 | header.offset[1] << 16 | header.offset[2] << 8 | header.offset[3];
+  uint16_t length = header.length[0] << 8 | header.length[1];
+
+  if (offset >= sizeof(stream.slots[0])) {
+    streamStats.malformed++;
+    return;
+  }
+
+  // The clock gives way as soon as there is something to show instead
+  if (stream.fallback) {
+    LOG_INFO("Stream: receiving");
+    stream.fallback = false;
+    clearLeds();
+  }
+
+  // With nothing waiting ahead of it the frame is built where it is drawn
+  bool direct = !stream.readyCount && !stream.partial && !stream.pushedDirect;
+  uint8_t *target = (uint8_t *) leds;
+
+  if (!direct) {
+    target = (uint8_t *) stream.slots[stream.assembling];
+    if (!stream.partial) {
+      // Senders may only update part of the frame, start from the newest complete one
+      uint8_t newest = (stream.assembling + STREAM_SLOTS - 1) % STREAM_SLOTS;
+      memcpy(target, stream.readyCount ? stream.slots[newest] : leds, sizeof(stream.slots[0]));
+      stream.partial = true;
+    }
+  }
+
+  // Straight from the socket into the frame, LEDs past the end of the chain are dropped
+  streamUDP.read(target + offset, min<uint32_t>(length, sizeof(stream.slots[0]) - offset));
+
+  stream.lastPacketMs = millis();
+  streamStats.packets++;
+  streamStats.windowPackets++;
+
+  if (header.flags & DDP_FLAG_PUSH) {
+    streamStats.frames++;
+
+    if (direct) {
+      stream.directUs = micros();
+      stream.pushedDirect = true;
+      return;
+    }
+
+    uint8_t completed = stream.assembling;
+    stream.completedUs[completed] = micros();
+    stream.partial = false;
+
+    if (stream.readyCount == STREAM_SLOTS - 1) {
+      streamStats.overruns++; // the oldest waiting frame is about to be assembled over
+    } else {
+      stream.readyCount++;
+    }
+    stream.assembling = (completed + 1) % STREAM_SLOTS;
+  }
+}
+
+/**
+ * @brief Stop listening and give the jitter buffer back, when another program takes over
+ *
+ * Closing the socket keeps packets from queueing up in lwIP while nothing reads them. The stream
+ * may still be drawn as the outgoing side of a transition, it then only runs down its fallback.
+ */
+void stopStream() {
+  streamUDP.stop();
+  free(stream.slots);
+  stream.slots = nullptr;
+  stream.readyCount = 0;
+  stream.partial = false;
+}
+
+/**
+ * @brief Show pixels pushed by a show controller over DDP, or the clock while there are none
+ */
+void programStream(const FrameContext_t &context) {
+  if (context.first) {
+    CRGB (*slots)[NUM_PHYSICAL_LEDS] = stream.slots;
+    memset(&stream, 0, sizeof(stream));
+    stream.slots = slots ? slots : (CRGB (*)[NUM_PHYSICAL_LEDS]) malloc(STREAM_SLOTS * sizeof(stream.slots[0]));
+    stream.fallback = true;
+    clearLeds();
+
+    if (stream.slots) {
+      streamUDP.begin(STREAM_PORT);
+    } else {
+      LOG_ERROR("Stream: no room for %u frames, not listening", STREAM_SLOTS);
+    }
+  }
+
+  for (uint8_t n = 0; stream.slots && n < STREAM_MAX_PACKETS; n++) {
+    int size = streamUDP.parsePacket();
+    if (!size) break;
+    readStreamPacket(size);
+  }
+
+  if (context.nowMs - streamStats.windowStartMs >= 1000) {
+    streamStats.packetsPerSecond = streamStats.windowPackets;
+    streamStats.windowPackets = 0;
+    streamStats.windowStartMs = context.nowMs;
+  }
+
+  if (stream.pushedDirect) {
+    recordProfile(streamLatency, stream.directUs);
+    stream.pushedDirect = false;
+    streamStats.shown++;
+    return;
+  }
+
+  if (stream.readyCount) {
+    uint8_t oldest = (stream.assembling + STREAM_SLOTS - stream.readyCount) % STREAM_SLOTS;
+    memcpy(leds, stream.slots[oldest], sizeof(stream.slots[0]));
+    recordProfile(streamLatency, stream.completedUs[oldest]);
+    stream.readyCount--;
+    streamStats.shown++;
+    return;
+  }
+
+  // The clock starts over whenever it takes over the display
+  bool entering = context.first;
+  if (!stream.fallback && context.nowMs - stream.lastPacketMs > STREAM_TIMEOUT_MS) {
+    LOG_INFO("Stream: stopped, showing the clock");
+    stream.fallback = true;
+    stream.partial = false;
+    streamStats.fallbacks++;
+    clearLeds();
+    entering = true;
+  }
+
+  if (stream.fallback) {
+    FrameContext_t clockContext = context;
+    clockContext.first = entering;
+    programClock(clockContext);
+  }
+}
+
+
+// =-------------------------------------------------------------------------------= Filesystem =--=
+
+void setupFilesystem() {
+  loadConfig();
+}
+
+void loadConfig() {
+  if (!LittleFS.begin()) {
+    LOG_ERROR("Failed to mount FS");
+    return;
+  }
+
+  if (!LittleFS.exists(CONFIG_FILE)) {
+    LOG_WARN("Config file doesn't exist.");
+    return;
+  }
+
+  File configFile = LittleFS.open(CONFIG_FILE, "r");
+
+  if (!configFile) {
+    LOG_ERROR("Failed to open config file for reading");
+    return;
+  }
+
+  StaticJsonDocument<512> doc;
+  DeserializationError error = deserializeJson(doc, configFile);
+
+  if (error) {
+    LOG_ERROR("Failed to read config file");
+  }
+
+  // Copied out, the lookup below mounts and unmounts the filesystem itself
+  char tz[TZ_NAME_SIZE];
+  strlcpy(tz, doc["timezone"] | TZ_UTC.name, sizeof(tz));
+
+  configFile.close();
+  LittleFS.end();
+
+  if (findTimezone(tz, currentTZ)) {
+    LOG_INFO("Loaded time zone: %s", tz);
+  } else {
+    LOG_WARN("Time zone %s not found, using %s", tz, currentTZ.name);
+  }
+}
+
+void saveConfig(const char *timezone) {
+  if (!LittleFS.begin()) {
+    LOG_ERROR("Failed to mount FS");
+    return;
+  }
+
+  File configFile = LittleFS.open(CONFIG_FILE, "w");
+
+  if (!configFile) {
+    LOG_ERROR("Failed to open config file for writing");
+    return;
+  }
+
+  StaticJsonDocument<512> doc;
+  doc["timezone"] = timezone;
+
+  if (serializeJson(doc, configFile) == 0) {
+    LOG_ERROR("Failed to write to file");
+  }
+
+  LOG_INFO("Saved time zone: %s", timezone);
+
+  configFile.close();
+  LittleFS.end();
+}
+
+
+// =-------------------------------------------------------------------------------= Time Zones =--=
+
+/**
+ * @brief Open the time zone database and check it was compiled for this firmware
+ *
+ * The filesystem must already be mounted.
+ *
+ * @param tzdb Opened on success.
+ * @param header Filled with the database's header.
+ * @return Whether the database can be read.
+ */
+bool openTzdb(File &tzdb, TzdbHeader_t &header) {
+  tzdb = LittleFS.open(TZDB_FILE, "r");
+
+  if (!tzdb) {
+    LOG_ERROR("No time zone database at %s, upload the filesystem image", TZDB_FILE);
+    return false;
+  }
+
+  if (tzdb.read((uint8_t *) &header, sizeof(header)) != sizeof(header) || header.magic != TZDB_MAGIC ||
+      header.version != TZDB_VERSION || header.recordSize != sizeof(Timezone_t)) {
+    LOG_ERROR("Time zone database %s doesn't match this firmware, run bin/tzdb-compile", TZDB_FILE);
+    tzdb.close();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Read one record by seeking straight to it
+ *
+ * @param tzdb Database opened with openTzdb().
+ * @param header The database's header.
+ * @param index Record to read, in name order.
+ * @param zone Filled with the record.
+ * @return Whether the record could be read.
+ */
+bool readTimezone(File &tzdb, const TzdbHeader_t &header, uint16_t index, Timezone_t &zone) {
+  if (!tzdb.seek(sizeof(TzdbHeader_t) + (uint32_t) index * header.recordSize) ||
+      tzdb.read((uint8_t *) &zone, sizeof(zone)) != sizeof(zone)) {
+    return false;
+  }
+
+  zone.name[TZ_NAME_SIZE - 1] = '\0';
+  zone.stdAbbrev[TZ_ABBREV_SIZE - 1] = '\0';
+  zone.dstAbbrev[TZ_ABBREV_SIZE - 1] = '\0';
+  return true;
+}
+
+/**
+ * @brief Look a zone up by name in the time zone database
+ *
+ * The records are sorted by case-folded name, so this is a binary search reading one record per
+ * step. Only the zone found ends up in RAM, however many the database holds.
+ *
+ * @param name IANA name, matched case-insensitively.
+ * @param zone Filled with the zone when found, untouched otherwise.
+ * @return Whether the zone was found.
+ */
+bool findTimezone(const char *name, Timezone_t &zone) {
+  if (!LittleFS.begin()) {
+    LOG_ERROR("Failed to mount FS");
+    return false;
+  }
+
+  File tzdb;
+  TzdbHeader_t header;
+  bool found = false;
+
+  if (openTzdb(tzdb, header)) {
+    uint16_t low = 0;
+    uint16_t high = header.count;
+    Timezone_t record;
+
+    while (low < high && !found) {
+      uint16_t middle = low + (high - low) / 2;
+      if (!readTimezone(tzdb, header, middle, record)) break;
+
+      int order = strcasecmp(name, record.name);
+      if (order == 0) {
+        zone = record;
+        found = true;
+      } else if (order < 0) {
+        high = middle;
+      } else {
+        low = middle + 1;
+      }
+    }
+
+    tzdb.close();
+  }
+
+  LittleFS.end();
+  return found;
+}
+
+/**
+ * @brief List the selectable zones, one name per line
+ *
+ * Streamed a record at a time in small chunks, so the list costs no RAM however long it grows.
+ */
+void portalTimezonesPage() {
+  if (!LittleFS.begin()) {
+    Server.send(500, "text/plain", "Failed to mount FS\n");
+    return;
+  }
+
+  File tzdb;
+  TzdbHeader_t header;
+
+  if (!openTzdb(tzdb, header)) {
+    LittleFS.end();
+    Server.send(503, "text/plain", "No time zone database\n");
+    return;
+  }
+
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "text/plain", "");
+
+  char chunk[256];
+  size_t length = 0;
+  Timezone_t zone;
+
+  for (uint16_t index = 0; index < header.count && readTimezone(tzdb, header, index, zone); index++) {
+    if (zone.flags & TZ_FLAG_ALIAS) continue;
+
+    size_t nameLength = strlen(zone.name);
+    if (length + nameLength + 1 > sizeof(chunk)) {
+      Server.sendContent(chunk, length);
+      length = 0;
+    }
+
+    memcpy(chunk + length, zone.name, nameLength);
+    chunk[length + nameLength] = '\n';
+    length += nameLength + 1;
+  }
+
+  if (length) Server.sendContent(chunk, length);
+  Server.sendContent("");
+
+  tzdb.close();
+  LittleFS.end();
+}
+
+
+// =------------------------------------------------------------------------------= OTA Updates =--=
+
+void setupOTA() {
+  ArduinoOTA.setPort(OTA_PORT);
+  ArduinoOTA.setHostname(MDNS_HOSTNAME);
+
+  // Update.installSignature( &hash, &sign );
+  ArduinoOTA.onStart([]() {
+    const char *type;
+    if (ArduinoOTA.getCommand() == U_FLASH) {
+      type = "sketch";
+    } else { // U_FS
+      type = "filesystem";
+    }
+
+    otaInProgress = true;
+    clearDisplay();
+
+    // NOTE: if updating FS this would be the place to unmount FS using FS.end()
+    LOG_INFO("OTA: Start updating %s", type);
+  });
+
+  ArduinoOTA.onEnd([]() {
+    otaInProgress = false;
+    LOG_INFO("OTA End");
+  });
+
+  ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
+    static uint8_t lastPercent = 0;
+    uint8_t percent = (progress / (total / 100));
+    writeProgressBar(percent, colorYellow);
+
+    // Called for every chunk received, only log whole percent steps
+    if (percent != lastPercent) LOG_DEBUG("OTA Progress: %u%%", percent);
+    lastPercent = percent;
+  });
+
+  ArduinoOTA.onError([](ota_error_t error) {
+    otaInProgress = false;
+
+    if (error == OTA_AUTH_ERROR) {
+      LOG_ERROR("OTA: Error[%u]: Auth Failed", error);
+    } else if (error == OTA_BEGIN_ERROR) {
+      LOG_ERROR("OTA: Error[%u]: Begin Failed", error);
+    } else if (error == OTA_CONNECT_ERROR) {
+      LOG_ERROR("OTA: Error[%u]: Connect Failed", error);
+    } else if (error == OTA_RECEIVE_ERROR) {
+      LOG_ERROR("OTA: Error[%u]: Receive Failed", error);
+    } else if (error == OTA_END_ERROR) {
+      LOG_ERROR("OTA: Error[%u]: End Failed", error);
+      flushLog();
+      delay(2000);
+      ESP.restart(); // NTP seems to fail after OTA failures, reboot
+    }
+  });
+
+  LOG_INFO("OTA Setup");
+  ArduinoOTA.begin();
+}
+
+void loopOTA() {
+  uint32_t start = beginStage(PROFILE_OTA, currentProgram);
+  ArduinoOTA.handle();
+  endStage(PROFILE_OTA, currentProgram, start);
+}
+
+// =-------------------------------------------------------------------------------= Benchmarks =--=
+
+#ifdef BENCHMARK
+
+#define BENCHMARK_FRAMES                          100
+
+/**
+ * @brief Time a renderer over a run of frames and print the average cost over serial
+ *
+ * @param name Label for the output.
+ * @param render Draws one frame for the given animation time in milliseconds.
+ */
+void benchmarkRender(const char *name, void (*render)(uint32_t time)) {
+  uint32_t start = micros();
+  for (uint16_t frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    render(frame * FIRE_UPDATE_MS);
+    yield();
+  }
+  LOG_INFO("Benchmark %-16s %6lu us/frame", name, (micros() - start) / BENCHMARK_FRAMES);
+}
+
+/**
+ * The original fire: full Perlin noise and a palette blend for every cell of the matrix
+ */
+void renderFireReference(uint32_t time) {
+  for (int i = 0; i < MATRIX_WIDTH; i++) {
+    for (int j = 0; j < MATRIX_HEIGHT; j++) {
+      leds[XY(i, j)] = ColorFromPalette(HeatColors_p, qsub8(inoise8(i * 60, j * 60 + time, time / 3),
+      abs8(j - (MATRIX_HEIGHT - 1)) * 255 / (MATRIX_HEIGHT - 1)), 255);
+    }
+  }
+}
+
+/**
+ * The original rainbow: a CHSV conversion for every cell of the matrix
+ */
+void renderRainbowReference(uint32_t time) {
+  int8_t yHueDelta8 = ((int32_t) cos16(time * (27 / 3)) * (350 / MATRIX_WIDTH)) / 32768;
+  int8_t xHueDelta8 = ((int32_t) cos16(time * (39 / 3)) * (310 / MATRIX_HEIGHT)) / 32768;
+
+  byte lineStartHue = time / 65536;
+  for (byte y = 0; y < MATRIX_HEIGHT; y++) {
+    lineStartHue += yHueDelta8;
+    byte pixelHue = lineStartHue;
+    for (byte x = 0; x < MATRIX_WIDTH; x++) {
+      pixelHue += xHueDelta8;
+      leds[XY(x, y)] = CHSV(pixelHue, 255, 255);
+    }
+  }
+}
+
+/**
+ * The original plasma: three sine waves and a CHSV conversion for every cell of the matrix
+ */
+void renderPlasmaReference(uint32_t time) {
+  uint16_t t = time;
+  for (int16_t x = 0; x < MATRIX_WIDTH; x++) {
+    for (int16_t y = 0; y < MATRIX_HEIGHT; y++) {
+      int16_t r = sin16(t) / 256;
+      int16_t h = sin16(x * r * _plasmaXfactor + t) + cos16(y * (-r) * _plasmaYfactor + t) + sin16(y * x * (cos16(-t) / 256) / 2);
+      leds[XY(x, y)] = CHSV((uint8_t)((h / 256) + 128), 255, 255);
+    }
+  }
+}
+
+/**
+ * @brief Scale every byte of a buffer, four channels per 32-bit operation
+ *
+ * Matches CRGB::nscale8() on each channel. The buffer must be 4-byte aligned.
+ *
+ * @param data Bytes to scale in place.
+ * @param count Number of bytes.
+ * @param scale Scale factor, 255 leaves the data unchanged.
+ */
+void scaleBytes(uint8_t *data, uint16_t count, uint8_t scale) {
+  uint32_t weight = scale + 1;
+  uint16_t words = count / 4;
+
+  for (uint16_t n = 0; n < words; n++) {
+    uint32_t word = ((swar32_t *) data)[n];
+    uint32_t even = ((word & 0x00FF00FF) * weight) >> 8;
+    uint32_t odd = ((word >> 8) & 0x00FF00FF) * weight;
+    ((swar32_t *) data)[n] = (even & 0x00FF00FF) | (odd & 0xFF00FF00);
+  }
+
+  for (uint16_t n = words * 4; n < count; n++) {
+    data[n] = (data[n] * weight) >> 8;
+  }
+}
+
+/**
+ * Fading the physical frame one pixel at a time, as the matrix rain used to
+ */
+void benchmarkScaleScalar(uint32_t time) {
+  for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) frame[led].nscale8(192);
+}
 
-  if (serializeJson(doc, configFile) == 0) {
-    Serial.println(("Dailed to write to file"));
+void benchmarkScaleSwar(uint32_t time) {
+  scaleBytes((uint8_t *) frame, sizeof(frame), 192);
+}
+
+/**
+ * Crossfading the physical frame one pixel at a time with FastLED's blend()
+ */
+void benchmarkBlendScalar(uint32_t time) {
+  for (uint16_t led = 0; led < NUM_PHYSICAL_LEDS; led++) {
+    frame[led] = blend(transitionFrame[led], frame[led], time);
   }
+}
+
+void benchmarkBlendSwar(uint32_t time) {
+  blendBytes((uint8_t *) frame, (uint8_t *) transitionFrame, (uint8_t *) frame, sizeof(frame), time & 0xFF);
+}
 
-  Serial.println("Saved time zone: " + timezone);
+void setupBenchmark() {
+  benchmarkRender("fire reference", renderFireReference);
+  benchmarkRender("fire", renderFire);
 
-  configFile.close();
-  LittleFS.end();
+  benchmarkRender("rainbow reference", renderRainbowReference);
+  benchmarkRender("rainbow", renderRainbow);
+  benchmarkRender("plasma reference", renderPlasmaReference);
+  benchmarkRender("plasma", renderPlasma);
+  benchmarkRender("ripple", renderRipple);
+
+  benchmarkRender("nscale8 scalar", benchmarkScaleScalar);
+  benchmarkRender("scale swar", benchmarkScaleSwar);
+  benchmarkRender("blend scalar", benchmarkBlendScalar);
+  benchmarkRender("blend swar", benchmarkBlendSwar);
+
+  clearDisplay();
 }
 
+#endif
 
-// =------------------------------------------------------------------------------= OTA Updates =--=
 
-void setupOTA() {
-  ArduinoOTA.setPort(OTA_PORT);
-  ArduinoOTA.setHostname(MDNS_HOSTNAME);
+// =--------------------------------------------------------------------------------= Scheduler =--=
 
-  // Update.installSignature( &hash, &sign );
-  ArduinoOTA.onStart([]() {
-    String type;
-    if (ArduinoOTA.getCommand() == U_FLASH) {
-      type = "sketch";
-    } else { // U_FS
-      type = "filesystem";
+void taskDisplay() {
+  if (WiFi.status() == WL_CONNECTED && !otaInProgress) loopDisplay();
+}
+
+void taskSurprise() {
+  if (WiFi.status() == WL_CONNECTED && !otaInProgress) {
+    uint32_t start = beginStage(PROFILE_SURPRISE, currentProgram);
+    surpriseAndDelight();
+    endStage(PROFILE_SURPRISE, currentProgram, start);
+  }
+}
+
+void taskClock() {
+  if (WiFi.status() == WL_CONNECTED) loopClock();
+}
+
+// Display first so frames go out on time, then the network so requests never wait long
+Task_t tasks[] = {
+  { "portal",   loopPortal,      PORTAL_UPDATE_MS,    1 },
+  { "ota",      loopOTA,         OTA_UPDATE_MS,       1 },
+  { "display",  taskDisplay,     0,                   0 },
+  { "surprise", taskSurprise,    SURPRISE_UPDATE_MS,  2 },
+  { "clock",    taskClock,       0,                   2 },
+  { "report",   reportScheduler, SCHEDULER_REPORT_MS, 3 },
+  { "log",      drainLog,        LOG_DRAIN_MS,        2 },
+  { "events",   pushEvents,      EVENTS_UPDATE_MS,    2 },
+  { "preview",  loopPreview,     PORTAL_UPDATE_MS,    2 }
+};
+static_assert(sizeof(tasks) / sizeof(tasks[0]) == TASK_COUNT, "Every task id needs a task");
+
+void reportScheduler() {
+  LOG_INFO("Scheduler: %u.%u%% busy", schedulerStats.busyPermille / 10, schedulerStats.busyPermille % 10);
+
+  for (Task_t &task : tasks) {
+    LOG_DEBUG(
+      "  %-8s %8lu runs, late %lu ms avg %lu ms max", task.name, task.runs,
+      task.runs > 1 ? task.lateMs / (task.runs - 1) : 0, task.lateMaxMs
+    );
+  }
+}
+
+/**
+ * @brief Set when a self-scheduling task runs next
+ *
+ * @param task Task to schedule.
+ * @param dueMs millis() to run it at, or any time already passed to run it right away.
+ */
+void scheduleTask(TaskId_t task, uint32_t dueMs) {
+  tasks[task].dueMs = dueMs;
+}
+
+/**
+ * @brief Run every task that is due, then sleep until the next deadline
+ *
+ * When several tasks are due the one with the lowest priority number goes first. Periodic tasks
+ * advance their deadline by whole periods, or restart from now when more than a period late.
+ * The SDK gets a yield() after every task. Sleeping in delay() rather than spinning lets the SDK put the modem to sleep between DTIM
+ * beacons, and the portal's short period bounds how long a web request can wait.
+ */
+void loopScheduler() {
+  uint32_t now = millis();
+  uint32_t passUs = 0;
+
+  while (true) {
+    Task_t *next = nullptr;
+    for (Task_t &task : tasks) {
+      if ((int32_t) (now - task.dueMs) >= 0 && (!next || task.priority < next->priority)) next = &task;
     }
+    if (!next) break;
 
-    otaInProgress = true;
-    clearDisplay();
+    // Every task is first due at boot, only count lateness from then on
+    uint32_t late = now - next->dueMs;
+    if (next->runs++) {
+      next->lateMs += late;
+      next->lateMaxMs = max(next->lateMaxMs, late);
+    }
 
-    // NOTE: if updating FS this would be the place to unmount FS using FS.end()
-    Serial.println("OTA: Start updating " + type);
-  });
+    if (!next->periodMs) {
+      next->dueMs = now + SCHEDULER_FALLBACK_MS;
+    } else if (late >= next->periodMs) {
+      next->dueMs = now + next->periodMs;
+    } else {
+      next->dueMs += next->periodMs;
+    }
 
-  ArduinoOTA.onEnd([]() {
-    otaInProgress = false;
-    Serial.println("\nOTA End");
-  });
+    uint32_t start = micros();
+    next->run();
+    uint32_t busy = micros() - start;
+    schedulerStats.busyUs += busy;
+    passUs += busy;
 
-  ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-    uint8_t percent = (progress / (total / 100));
-    writeProgressBar(percent, colorYellow);
+    // Let the SDK and lwIP run between tasks, a pass with several tasks due can outlast the
+    // watchdog and hold up the WiFi stack
+    yield();
+    now = millis();
+  }
 
-    Serial.printf("OTA Progress: %u%%\r", percent);
-  });
+  if (passUs) {
+    stallRecord.loopUs = passUs;
+    stallRecord.loopMaxUs = max(stallRecord.loopMaxUs, passUs);
+    ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *) &stallRecord, sizeof(stallRecord));
+  }
 
-  ArduinoOTA.onError([](ota_error_t error) {
-    Serial.printf("OTA: Error[%u]: ", error);
-    otaInProgress = false;
+  int32_t wait = INT32_MAX;
+  for (Task_t &task : tasks) {
+    wait = min(wait, (int32_t) (task.dueMs - now));
+  }
 
-    if (error == OTA_AUTH_ERROR) {
-      Serial.println("OTA: Auth Failed");
-    } else if (error == OTA_BEGIN_ERROR) {
-      Serial.println("OTA: Begin Failed");
-    } else if (error == OTA_CONNECT_ERROR) {
-      Serial.println("OTA: Connect Failed");
-    } else if (error == OTA_RECEIVE_ERROR) {
-      Serial.println("OTA: Receive Failed");
-    } else if (error == OTA_END_ERROR) {
-      Serial.println("OTA: End Failed");
-      delay(2000);
-      ESP.restart(); // NTP seems to fail after OTA failures, reboot
+  if (wait > 0) delay(wait);
+
+  uint32_t window = micros() - schedulerStats.windowStartUs;
+  if (window >= SCHEDULER_STATS_WINDOW_MS * 1000UL) {
+    schedulerStats.busyPermille = (uint64_t) schedulerStats.busyUs * 1000 / window;
+    schedulerStats.busyUs = 0;
+    schedulerStats.windowStartUs = micros();
+  }
+}
+
+
+// =---------------------------------------------------------------------------------= Profiler =--=
+
+/**
+ * @brief Add the time since startUs to a histogram
+ *
+ * @param histogram Histogram to count the sample in.
+ * @param startUs micros() when the timed stage started.
+ */
+void recordProfile(Histogram_t &histogram, uint32_t startUs) {
+  recordSample(histogram, micros() - startUs);
+}
+
+/**
+ * @brief Count a duration in a histogram
+ *
+ * @param histogram Histogram to count the sample in.
+ * @param us Duration in microseconds.
+ */
+void recordSample(Histogram_t &histogram, uint32_t us) {
+  uint8_t bucket = 0;
+
+  while (bucket < PROFILE_BUCKETS - 1 && us > profileBucketUs[bucket]) bucket++;
+
+  histogram.counts[bucket]++;
+  histogram.samples++;
+  histogram.sumUs += us;
+  histogram.maxUs = max(histogram.maxUs, us);
+}
+
+/**
+ * @brief Leave a breadcrumb in RTC memory and start timing a stage
+ *
+ * @param stage Stage about to run.
+ * @param program Program current, or being rendered, in that stage.
+ * @return micros() at the start, for endStage().
+ */
+uint32_t beginStage(ProfileStage_t stage, uint8_t program) {
+  if (stallRecord.depth < STALL_MAX_DEPTH) {
+    outerStage[stallRecord.depth] = stallRecord.stage;
+    outerProgram[stallRecord.depth] = stallRecord.program;
+  }
+
+  stallRecord.stage = stage;
+  stallRecord.program = program;
+  stallRecord.uptimeMs = millis();
+  stallRecord.freeHeap = ESP.getFreeHeap();
+  stallRecord.depth++;
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *) &stallRecord, sizeof(stallRecord));
+
+  return micros();
+}
+
+/**
+ * @brief Finish timing a stage, recording it in the stage histogram and as the longest if it was
+ *
+ * A nested stage hands the breadcrumb back to the one it ran inside, so a stall after e.g. a
+ * program switch from the portal is still blamed on the portal rather than the frame it drew.
+ */
+void endStage(ProfileStage_t stage, uint8_t program, uint32_t startUs) {
+  recordProfile(stageProfile[stage], startUs);
+
+  uint32_t us = micros() - startUs;
+  if (us > stallRecord.longestUs) {
+    stallRecord.longestUs = us;
+    stallRecord.longestStage = stage;
+    stallRecord.longestProgram = program;
+  }
+
+  stallRecord.depth--;
+  if (stallRecord.depth > 0 && stallRecord.depth < STALL_MAX_DEPTH) {
+    stallRecord.stage = outerStage[stallRecord.depth];
+    stallRecord.program = outerProgram[stallRecord.depth];
+  }
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *) &stallRecord, sizeof(stallRecord));
+}
+
+/**
+ * @brief Pick up the breadcrumbs of the previous run if it ended in a reset, then start over
+ *
+ * Power on leaves RTC memory random and an external reset says nothing about the firmware, so only
+ * watchdog, exception and software resets are reported.
+ */
+void setupStallDetector() {
+  rst_info *reset = ESP.getResetInfoPtr();
+  strlcpy(lastResetReason, ESP.getResetReason().c_str(), sizeof(lastResetReason));
+
+  ESP.rtcUserMemoryRead(STALL_RTC_OFFSET, (uint32_t *) &lastStall, sizeof(lastStall));
+  lastStallValid = lastStall.magic == STALL_MAGIC && (
+    reset->reason == REASON_WDT_RST || reset->reason == REASON_EXCEPTION_RST ||
+    reset->reason == REASON_SOFT_WDT_RST || reset->reason == REASON_SOFT_RESTART
+  );
+
+  if (lastStallValid) {
+    LOG_WARN(
+      "Reset by %s %s %s (%s) at %lu ms with %lu bytes free, longest stall %lu us in %s (%s)",
+      lastResetReason, lastStall.depth ? "in" : "after", profileStageNames[lastStall.stage % PROFILE_STAGE_COUNT],
+      programNames[lastStall.program % PROGRAM_COUNT], lastStall.uptimeMs, lastStall.freeHeap, lastStall.longestUs,
+      profileStageNames[lastStall.longestStage % PROFILE_STAGE_COUNT], programNames[lastStall.longestProgram % PROGRAM_COUNT]
+    );
+  }
+
+  memset(&stallRecord, 0, sizeof(stallRecord));
+  stallRecord.magic = STALL_MAGIC;
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *) &stallRecord, sizeof(stallRecord));
+}
+
+/**
+ * @brief Serve the post-mortem of the last reset, and the longest stall of this run
+ */
+void portalStallPage() {
+  char content[320];
+  size_t length = snprintf_P(
+    content, sizeof(content), PSTR("reset: %s\nlongest now: %lu us in %s (%s), loop max %lu us\n"),
+    lastResetReason, stallRecord.longestUs, profileStageNames[stallRecord.longestStage],
+    programNames[stallRecord.longestProgram], stallRecord.loopMaxUs
+  );
+
+  if (lastStallValid && length < sizeof(content)) {
+    snprintf_P(
+      content + length, sizeof(content) - length,
+      PSTR("last stage: %s %s (%s) at %lu ms\nfree heap: %lu\nloop: %lu us, max %lu us\nlongest: %lu us in %s (%s)\n"),
+      lastStall.depth ? "in" : "after", profileStageNames[lastStall.stage % PROFILE_STAGE_COUNT],
+      programNames[lastStall.program % PROGRAM_COUNT], lastStall.uptimeMs, lastStall.freeHeap,
+      lastStall.loopUs, lastStall.loopMaxUs, lastStall.longestUs,
+      profileStageNames[lastStall.longestStage % PROFILE_STAGE_COUNT], programNames[lastStall.longestProgram % PROGRAM_COUNT]
+    );
+  }
+
+  Server.send(200, "text/plain", content);
+}
+
+char metricsBuffer[METRICS_CHUNK_SIZE];
+size_t metricsLength = 0;
+
+/**
+ * @brief Append a line to the /metrics response, sending a chunk whenever the buffer fills
+ *
+ * @param format printf format in PROGMEM.
+ */
+void sendMetric(PGM_P format, ...) {
+  char line[160];
+  va_list args;
+
+  va_start(args, format);
+  size_t length = min<size_t>(vsnprintf_P(line, sizeof(line), format, args), sizeof(line) - 1);
+  va_end(args);
+
+  if (metricsLength + length > sizeof(metricsBuffer)) {
+    Server.sendContent(metricsBuffer, metricsLength);
+    metricsLength = 0;
+  }
+
+  memcpy(metricsBuffer + metricsLength, line, length);
+  metricsLength += length;
+}
+
+/**
+ * @brief Write one histogram as Prometheus cumulative buckets, sum and count
+ */
+void sendHistogram(const char *name, const char *label, const char *value, const Histogram_t &histogram) {
+  uint32_t cumulative = 0;
+
+  for (uint8_t bucket = 0; bucket < PROFILE_BUCKETS - 1; bucket++) {
+    cumulative += histogram.counts[bucket];
+    sendMetric(
+      PSTR("%s_bucket{%s=\"%s\",le=\"%lu.%06lu\"} %lu\n"), name, label, value,
+      profileBucketUs[bucket] / 1000000, profileBucketUs[bucket] % 1000000, cumulative
+    );
+  }
+
+  sendMetric(PSTR("%s_bucket{%s=\"%s\",le=\"+Inf\"} %lu\n"), name, label, value, histogram.samples);
+  sendMetric(
+    PSTR("%s_sum{%s=\"%s\"} %lu.%06lu\n"), name, label, value,
+    (uint32_t) (histogram.sumUs / 1000000), (uint32_t) (histogram.sumUs % 1000000)
+  );
+  sendMetric(PSTR("%s_count{%s=\"%s\"} %lu\n"), name, label, value, histogram.samples);
+}
+
+/**
+ * @brief Serve loop timing in the Prometheus text format
+ *
+ * Streamed in chunks from a fixed buffer, so a scrape needs no heap however many series there are.
+ */
+void portalMetricsPage() {
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "text/plain; version=0.0.4", "");
+  metricsLength = 0;
+
+  sendMetric(PSTR("# HELP clock_stage_seconds Time spent in each main loop stage.\n"));
+  sendMetric(PSTR("# TYPE clock_stage_seconds histogram\n"));
+  for (uint8_t stage = 0; stage < PROFILE_STAGE_COUNT; stage++) {
+    sendHistogram("clock_stage_seconds", "stage", profileStageNames[stage], stageProfile[stage]);
+  }
+
+  sendMetric(PSTR("# HELP clock_render_seconds Time each program takes to draw a frame.\n"));
+  sendMetric(PSTR("# TYPE clock_render_seconds histogram\n"));
+  for (uint8_t program = 0; program < PROGRAM_COUNT; program++) {
+    sendHistogram("clock_render_seconds", "program", programNames[program], renderProfile[program]);
+  }
+
+  sendMetric(PSTR("# HELP clock_present_seconds Time to present a program's frame, including the show.\n"));
+  sendMetric(PSTR("# TYPE clock_present_seconds histogram\n"));
+  for (uint8_t program = 0; program < PROGRAM_COUNT; program++) {
+    sendHistogram("clock_present_seconds", "program", programNames[program], presentProfile[program]);
+  }
+
+  sendMetric(PSTR("# TYPE clock_task_runs_total counter\n"));
+  for (Task_t &task : tasks) {
+    sendMetric(PSTR("clock_task_runs_total{task=\"%s\"} %lu\n"), task.name, task.runs);
+  }
+
+  sendMetric(PSTR("# TYPE clock_task_late_max_seconds gauge\n"));
+  for (Task_t &task : tasks) {
+    sendMetric(
+      PSTR("clock_task_late_max_seconds{task=\"%s\"} %lu.%03lu\n"), task.name,
+      task.lateMaxMs / 1000, task.lateMaxMs % 1000
+    );
+  }
+
+  sendMetric(PSTR("# TYPE clock_loop_busy_ratio gauge\n"));
+  sendMetric(
+    PSTR("clock_loop_busy_ratio %u.%03u\n"), schedulerStats.busyPermille / 1000, schedulerStats.busyPermille % 1000
+  );
+
+  sendMetric(PSTR("# HELP clock_edge_error_seconds How long after the second edge the clock's frames start.\n"));
+  sendMetric(PSTR("# TYPE clock_edge_error_seconds histogram\n"));
+  sendHistogram("clock_edge_error_seconds", "program", programNames[0], edgeError);
+  sendMetric(PSTR("# TYPE clock_edge_error_last_seconds gauge\n"));
+  sendMetric(PSTR("clock_edge_error_last_seconds 0.%06lu\n"), frameStats.edgeErrorUs);
+  sendMetric(PSTR("# TYPE clock_edge_error_max_seconds gauge\n"));
+  sendMetric(PSTR("clock_edge_error_max_seconds 0.%06lu\n"), frameStats.edgeErrorMaxUs);
+
+  sendMetric(PSTR("# TYPE clock_frames_total counter\n"));
+  sendMetric(PSTR("clock_frames_total %lu\n"), frameStats.frames);
+  sendMetric(PSTR("# TYPE clock_frames_presented_total counter\n"));
+  sendMetric(PSTR("clock_frames_presented_total %lu\n"), displayStats.framesPresented);
+  sendMetric(PSTR("# TYPE clock_frames_skipped_total counter\n"));
+  sendMetric(PSTR("clock_frames_skipped_total %lu\n"), displayStats.framesSkipped);
+  sendMetric(PSTR("# HELP clock_wire_saved_seconds_total Interrupt-off wire time not spent on padding or skipped frames.\n"));
+  sendMetric(PSTR("# TYPE clock_wire_saved_seconds_total counter\n"));
+  sendMetric(
+    PSTR("clock_wire_saved_seconds_total %lu.%06lu\n"),
+    (uint32_t) (displayStats.wireTimeSavedUs / 1000000), (uint32_t) (displayStats.wireTimeSavedUs % 1000000)
+  );
+  sendMetric(PSTR("# HELP clock_frames_dithered_total Unchanged frames re-sent to move the dither, see DITHER_REFRESH_MS.\n"));
+  sendMetric(PSTR("# TYPE clock_frames_dithered_total counter\n"));
+  sendMetric(PSTR("clock_frames_dithered_total %lu\n"), displayStats.framesDithered);
+  sendMetric(PSTR("# HELP clock_dither_wire_seconds_total Interrupt-off wire time spent re-sending frames for the dither.\n"));
+  sendMetric(PSTR("# TYPE clock_dither_wire_seconds_total counter\n"));
+  sendMetric(
+    PSTR("clock_dither_wire_seconds_total %lu.%06lu\n"),
+    (uint32_t) (displayStats.ditherWireUs / 1000000), (uint32_t) (displayStats.ditherWireUs % 1000000)
+  );
+  sendMetric(PSTR("# HELP clock_output_seconds Time spent mapping the last frame through the output table.\n"));
+  sendMetric(PSTR("# TYPE clock_output_seconds gauge\n"));
+  sendMetric(PSTR("clock_output_seconds 0.%06lu\n"), displayStats.outputUs);
+  sendMetric(PSTR("# TYPE clock_output_max_seconds gauge\n"));
+  sendMetric(PSTR("clock_output_max_seconds 0.%06lu\n"), displayStats.outputMaxUs);
+  sendMetric(PSTR("# TYPE clock_leds_touched gauge\n"));
+  sendMetric(PSTR("clock_leds_touched %u\n"), displayStats.ledsTouched);
+  sendMetric(PSTR("# TYPE clock_frame_rate gauge\n"));
+  sendMetric(PSTR("clock_frame_rate %u.%u\n"), frameStats.achievedFps10 / 10, frameStats.achievedFps10 % 10);
+
+  // The largest free block is what BearSSL needs in one piece to verify an OTA image
+  sendMetric(PSTR("# TYPE clock_heap_free_bytes gauge\n"));
+  sendMetric(PSTR("clock_heap_free_bytes %lu\n"), ESP.getFreeHeap());
+  sendMetric(PSTR("# TYPE clock_heap_max_free_block_bytes gauge\n"));
+  sendMetric(PSTR("clock_heap_max_free_block_bytes %lu\n"), ESP.getMaxFreeBlockSize());
+  sendMetric(PSTR("# TYPE clock_heap_fragmentation_ratio gauge\n"));
+  sendMetric(PSTR("clock_heap_fragmentation_ratio %u.%02u\n"), ESP.getHeapFragmentation() / 100, ESP.getHeapFragmentation() % 100);
+
+  sendMetric(PSTR("# HELP clock_preview_bytes_total Preview payload sent to each viewer slot.\n"));
+  sendMetric(PSTR("# TYPE clock_preview_bytes_total counter\n"));
+  for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+    sendMetric(PSTR("clock_preview_bytes_total{viewer=\"%u\"} %lu\n"), n, previewViewers[n].bytes);
+  }
+
+  sendMetric(PSTR("# TYPE clock_preview_frames_total counter\n"));
+  for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+    sendMetric(PSTR("clock_preview_frames_total{viewer=\"%u\"} %lu\n"), n, previewViewers[n].frames);
+  }
+
+  sendMetric(PSTR("# HELP clock_preview_skipped_total Frames not sent because the viewer's socket was still full.\n"));
+  sendMetric(PSTR("# TYPE clock_preview_skipped_total counter\n"));
+  for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+    sendMetric(PSTR("clock_preview_skipped_total{viewer=\"%u\"} %lu\n"), n, previewViewers[n].skipped);
+  }
+
+  sendMetric(PSTR("# HELP clock_preview_cpu_seconds_total Time spent encoding and sending to each viewer slot.\n"));
+  sendMetric(PSTR("# TYPE clock_preview_cpu_seconds_total counter\n"));
+  for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+    sendMetric(
+      PSTR("clock_preview_cpu_seconds_total{viewer=\"%u\"} %lu.%06lu\n"), n,
+      previewViewers[n].cpuUs / 1000000, previewViewers[n].cpuUs % 1000000
+    );
+  }
+
+  sendMetric(PSTR("# TYPE clock_stream_packets_total counter\n"));
+  sendMetric(PSTR("clock_stream_packets_total %lu\n"), streamStats.packets);
+  sendMetric(PSTR("# TYPE clock_stream_packets_per_second gauge\n"));
+  sendMetric(PSTR("clock_stream_packets_per_second %u\n"), streamStats.packetsPerSecond);
+  sendMetric(PSTR("# TYPE clock_stream_frames_total counter\n"));
+  sendMetric(PSTR("clock_stream_frames_total{state=\"received\"} %lu\n"), streamStats.frames);
+  sendMetric(PSTR("clock_stream_frames_total{state=\"shown\"} %lu\n"), streamStats.shown);
+  sendMetric(PSTR("clock_stream_frames_total{state=\"overrun\"} %lu\n"), streamStats.overruns);
+  sendMetric(PSTR("# TYPE clock_stream_dropped_packets_total counter\n"));
+  sendMetric(PSTR("clock_stream_dropped_packets_total{reason=\"duplicate\"} %lu\n"), streamStats.duplicates);
+  sendMetric(PSTR("clock_stream_dropped_packets_total{reason=\"late\"} %lu\n"), streamStats.late);
+  sendMetric(PSTR("clock_stream_dropped_packets_total{reason=\"malformed\"} %lu\n"), streamStats.malformed);
+  sendMetric(PSTR("# TYPE clock_stream_fallbacks_total counter\n"));
+  sendMetric(PSTR("clock_stream_fallbacks_total %lu\n"), streamStats.fallbacks);
+  sendMetric(PSTR("# HELP clock_stream_latency_seconds Push received to the frame being drawn.\n"));
+  sendMetric(PSTR("# TYPE clock_stream_latency_seconds histogram\n"));
+  sendHistogram("clock_stream_latency_seconds", "program", programNames[PROGRAM_STREAM], streamLatency);
+
+  uint8_t streams = 0;
+  for (EventClient_t &listener : eventClients) streams += listener.client.connected();
+  sendMetric(PSTR("# TYPE clock_event_streams gauge\n"));
+  sendMetric(PSTR("clock_event_streams %u\n"), streams);
+  sendMetric(PSTR("# HELP clock_events_skipped_total Status messages not sent because the stream's socket was still full.\n"));
+  sendMetric(PSTR("# TYPE clock_events_skipped_total counter\n"));
+  for (uint8_t n = 0; n < EVENTS_MAX_CLIENTS; n++) {
+    sendMetric(PSTR("clock_events_skipped_total{stream=\"%u\"} %lu\n"), n, eventClients[n].skipped);
+  }
+
+  sendMetric(PSTR("# TYPE clock_ntp_offset_seconds gauge\n"));
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    int64_t offset = ntpServers[n].offsetUs;
+    sendMetric(
+      PSTR("clock_ntp_offset_seconds{server=\"%s\"} %s%lu.%06lu\n"), NTP_SERVERS[n], offset < 0 ? "-" : "",
+      (uint32_t) (llabs(offset) / 1000000), (uint32_t) (llabs(offset) % 1000000)
+    );
+  }
+
+  sendMetric(PSTR("# TYPE clock_ntp_rtt_seconds gauge\n"));
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    sendMetric(
+      PSTR("clock_ntp_rtt_seconds{server=\"%s\"} %lu.%06lu\n"), NTP_SERVERS[n],
+      ntpServers[n].rttUs / 1000000, ntpServers[n].rttUs % 1000000
+    );
+  }
+
+  sendMetric(PSTR("# TYPE clock_ntp_replies_total counter\n"));
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    sendMetric(PSTR("clock_ntp_replies_total{server=\"%s\"} %lu\n"), NTP_SERVERS[n], ntpServers[n].replies);
+  }
+
+  sendMetric(PSTR("# TYPE clock_ntp_timeouts_total counter\n"));
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    sendMetric(PSTR("clock_ntp_timeouts_total{server=\"%s\"} %lu\n"), NTP_SERVERS[n], ntpServers[n].timeouts);
+  }
+
+  sendMetric(PSTR("# TYPE clock_ntp_outlier gauge\n"));
+  for (uint8_t n = 0; n < NTP_SERVER_COUNT; n++) {
+    sendMetric(PSTR("clock_ntp_outlier{server=\"%s\"} %u\n"), NTP_SERVERS[n], ntpServers[n].outlier);
+  }
+
+  sendMetric(PSTR("# TYPE clock_drift_ppb gauge\n"));
+  sendMetric(PSTR("clock_drift_ppb %ld\n"), (long) clockDiscipline.freqPpb);
+  sendMetric(PSTR("# TYPE clock_slew_pending_seconds gauge\n"));
+  sendMetric(
+    PSTR("clock_slew_pending_seconds %s0.%06lu\n"), clockDiscipline.slewUs < 0 ? "-" : "",
+    (uint32_t) (llabs(clockDiscipline.slewUs) % 1000000)
+  );
+  sendMetric(PSTR("# TYPE clock_ntp_poll_seconds gauge\n"));
+  sendMetric(PSTR("clock_ntp_poll_seconds %lu\n"), 1UL << clockDiscipline.pollExponent);
+
+  sendMetric(PSTR("# TYPE clock_ntp_rounds_total counter\n"));
+  sendMetric(PSTR("clock_ntp_rounds_total{result=\"ok\"} %lu\n"), ntp.rounds - ntp.failures);
+  sendMetric(PSTR("clock_ntp_rounds_total{result=\"failed\"} %lu\n"), ntp.failures);
+
+  sendMetric(PSTR("# HELP clock_ntp_tick_max_seconds Longest the loop has spent in one NTP step.\n"));
+  sendMetric(PSTR("# TYPE clock_ntp_tick_max_seconds gauge\n"));
+  sendMetric(PSTR("clock_ntp_tick_max_seconds %lu.%06lu\n"), ntp.tickMaxUs / 1000000, ntp.tickMaxUs % 1000000);
+
+  sendMetric(PSTR("# TYPE clock_log_dropped_bytes_total counter\n"));
+  sendMetric(PSTR("clock_log_dropped_bytes_total %lu\n"), logDropped);
+
+  sendMetric(PSTR("# TYPE clock_uptime_seconds counter\n"));
+  sendMetric(PSTR("clock_uptime_seconds %lu\n"), millis() / 1000);
+
+  Server.sendContent(metricsBuffer, metricsLength);
+  Server.sendContent("");
+}
+
+
+// =----------------------------------------------------------------------------------= Logging =--=
+
+/**
+ * @brief Format a log line into the ring and start sending it
+ *
+ * Use the LOG_ macros rather than calling this directly, they keep the format in flash and drop
+ * messages above LOG_LEVEL at compile time. Nothing here waits on the UART, if it falls a whole
+ * ring behind the oldest text is overwritten and counted as dropped.
+ *
+ * @param level Letter marking the level in the output.
+ * @param format printf format in PROGMEM, without a trailing newline.
+ */
+void logPrintf(char level, PGM_P format, ...) {
+  char line[LOG_LINE_SIZE];
+  uint32_t ms = millis();
+  va_list args;
+
+  size_t length = snprintf_P(line, sizeof(line), PSTR("%6lu.%03lu %c "), ms / 1000, ms % 1000, level);
+  va_start(args, format);
+  length += vsnprintf_P(line + length, sizeof(line) - length, format, args);
+  va_end(args);
+
+  length = min<size_t>(length, sizeof(line) - 2);
+  line[length++] = '\n';
+
+  for (size_t n = 0; n < length; n++) {
+    logBuffer[logWritten++ & (LOG_BUFFER_SIZE - 1)] = line[n];
+  }
+
+  if (logWritten - logSent > LOG_BUFFER_SIZE) {
+    logDropped += logWritten - logSent - LOG_BUFFER_SIZE;
+    logSent = logWritten - LOG_BUFFER_SIZE;
+  }
+
+  drainLog();
+}
+
+/**
+ * @brief Move as much of the log to the UART as its FIFO has room for right now
+ */
+void drainLog() {
+  while (logSent != logWritten) {
+    size_t room = Serial.availableForWrite();
+    if (!room) break;
+
+    uint32_t offset = logSent & (LOG_BUFFER_SIZE - 1);
+    size_t length = min<size_t>(min<size_t>(room, logWritten - logSent), LOG_BUFFER_SIZE - offset);
+    Serial.write(logBuffer + offset, length);
+    logSent += length;
+  }
+}
+
+/**
+ * @brief Block until the whole log is out, for just before a restart
+ */
+void flushLog() {
+  while (logSent != logWritten) {
+    drainLog();
+    yield();
+  }
+  Serial.flush();
+}
+
+/**
+ * @brief Serve the log ring, oldest first, straight from the buffer
+ */
+void portalLogPage() {
+  uint32_t start = logWritten > LOG_BUFFER_SIZE ? logWritten - LOG_BUFFER_SIZE : 0;
+  uint32_t offset = start & (LOG_BUFFER_SIZE - 1);
+
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "text/plain", "");
+
+  // At most two pieces, from the oldest byte to the end of the ring and then around to the head
+  size_t first = min<size_t>(logWritten - start, LOG_BUFFER_SIZE - offset);
+  if (first) Server.sendContent(logBuffer + offset, first);
+  if (logWritten - start > first) Server.sendContent(logBuffer, logWritten - start - first);
+  Server.sendContent("");
+}
+
+
+// =----------------------------------------------------------------------------------= Preview =--=
+
+void setupPreview() {
+  previewSocket.begin();
+  previewSocket.onEvent(onPreviewEvent);
+}
+
+/**
+ * @brief Give a new viewer a slot, or turn it away when they are all taken
+ */
+void onPreviewEvent(uint8_t client, WStype_t type, uint8_t *payload, size_t length) {
+  if (type == WStype_CONNECTED) {
+    for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+      PreviewViewer_t &viewer = previewViewers[n];
+      if (viewer.connected) continue;
+
+      memset(&viewer, 0, sizeof(viewer));
+      viewer.connected = true;
+      viewer.client = client;
+      viewer.keyframe = true;
+      viewer.connectedMs = millis();
+      viewer.writableMs = millis();
+      LOG_INFO("Preview: viewer %u connected", n);
+      return;
     }
-  });
 
-  Serial.println("OTA Setup");
-  ArduinoOTA.begin();
+    LOG_WARN("Preview: all %u viewer slots taken", PREVIEW_MAX_VIEWERS);
+    previewSocket.disconnect(client);
+  } else if (type == WStype_DISCONNECTED) {
+    for (uint8_t n = 0; n < PREVIEW_MAX_VIEWERS; n++) {
+      PreviewViewer_t &viewer = previewViewers[n];
+      if (!viewer.connected || viewer.client != client) continue;
+
+      // What one viewer cost, to judge how many a clock can take while holding its frame rate
+      uint32_t seconds = max<uint32_t>((millis() - viewer.connectedMs) / 1000, 1);
+      LOG_INFO(
+        "Preview: viewer %u left after %lu s, %lu frames, %lu skipped, %lu bytes/s, %lu us/s cpu", n, seconds,
+        viewer.frames, viewer.skipped, viewer.bytes / seconds, viewer.cpuUs / seconds
+      );
+      viewer.connected = false;
+    }
+  }
 }
 
-void loopOTA() {
-  ArduinoOTA.handle();
+/**
+ * @brief Encode the presented frame against what a viewer last received
+ *
+ * Changed LEDs are sent as runs, unless that would be no smaller than sending them all.
+ *
+ * @param viewer Viewer to encode for, updated to the frame encoded.
+ * @param message Buffer of PREVIEW_MESSAGE_SIZE bytes.
+ * @return Bytes to send, or 0 if nothing changed.
+ */
+size_t encodePreview(PreviewViewer_t &viewer, uint8_t *message) {
+  size_t length = 1;
+  uint16_t led = 0;
+
+  message[0] = 'D';
+  while (!viewer.keyframe && led < NUM_PHYSICAL_LEDS) {
+    if (frame[led] == viewer.sent[led]) {
+      led++;
+      continue;
+    }
+
+    uint16_t start = led;
+    while (led < NUM_PHYSICAL_LEDS && led - start < 255 && frame[led] != viewer.sent[led]) led++;
+
+    uint8_t count = led - start;
+    if (length + 3 + 3 * count >= PREVIEW_MESSAGE_SIZE) {
+      viewer.keyframe = true;
+      break;
+    }
+
+    message[length++] = start;
+    message[length++] = start >> 8;
+    message[length++] = count;
+    memcpy(message + length, &frame[start], 3 * count);
+    length += 3 * count;
+  }
+
+  if (viewer.keyframe) {
+    message[0] = 'K';
+    memcpy(message + 1, frame, sizeof(frame));
+    length = PREVIEW_MESSAGE_SIZE;
+    viewer.keyframe = false;
+  }
+
+  memcpy(viewer.sent, frame, sizeof(frame));
+  return length > 1 ? length : 0;
+}
+
+/**
+ * @brief Bytes a viewer's socket takes without blocking
+ *
+ * sendBIN() waits until the whole message is written, up to the library's TCP timeout, so it is
+ * only called with this much room.
+ */
+size_t PreviewServer_t::writeSpace(uint8_t client) {
+  WiFiClient *tcp = _clients[client].tcp;
+  return tcp && tcp->connected() ? tcp->availableForWrite() : 0;
+}
+
+/**
+ * @brief Service the socket and send each viewer whatever changed, at most every PREVIEW_UPDATE_MS
+ *
+ * The rate cap bounds how much of the loop a viewer can take, however fast its connection is. A
+ * viewer whose socket can't take a whole frame yet skips it, and is dropped after PREVIEW_STALL_MS
+ * of taking nothing.
+ */
+void loopPreview() {
+  static uint8_t message[PREVIEW_MESSAGE_SIZE];
+
+  previewSocket.loop();
+
+  for (PreviewViewer_t &viewer : previewViewers) {
+    if (!viewer.connected || millis() - viewer.lastSendMs < PREVIEW_UPDATE_MS) continue;
+    viewer.lastSendMs = millis();
+
+    // Checked before encoding, a skipped frame leaves what the viewer last received unchanged
+    if (previewSocket.writeSpace(viewer.client) < PREVIEW_MESSAGE_SIZE + PREVIEW_FRAME_HEADER) {
+      viewer.skipped++;
+      if (millis() - viewer.writableMs >= PREVIEW_STALL_MS) {
+        LOG_WARN(
+          "Preview: viewer %u took nothing for %u ms, dropping it", (unsigned) (&viewer - previewViewers),
+          PREVIEW_STALL_MS
+        );
+        previewSocket.disconnect(viewer.client);
+      }
+      continue;
+    }
+    viewer.writableMs = millis();
+
+    uint32_t start = micros();
+    size_t length = encodePreview(viewer, message);
+    if (length && previewSocket.sendBIN(viewer.client, message, length)) {
+      viewer.frames++;
+      viewer.bytes += length;
+    }
+    viewer.cpuUs += micros() - start;
+  }
+}
+
+void portalPreviewPage() {
+  Server.send_P(200, "text/html", PREVIEW_PAGE);
+}
+
+/**
+ * @brief Serve where each LED sits on the matrix, as flat x, y, address triples
+ */
+void portalLayoutPage() {
+  char buffer[256];
+  size_t length = snprintf_P(
+    buffer, sizeof(buffer), PSTR("{\"width\":%u,\"height\":%u,\"pixels\":["), MATRIX_WIDTH, MATRIX_HEIGHT
+  );
+
+  Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  Server.send(200, "application/json", "");
+
+  for (uint16_t n = 0; n < NUM_PHYSICAL_LEDS; n++) {
+    if (length > sizeof(buffer) - 20) {
+      Server.sendContent(buffer, length);
+      length = 0;
+    }
+
+    uint32_t pixel = pgm_read_dword(&PanelLayout.pixels[n]);
+    length += snprintf_P(
+      buffer + length, sizeof(buffer) - length, PSTR("%s%u,%u,%u"), n ? "," : "",
+      (uint8_t) pixel, (uint8_t) (pixel >> 8), (uint16_t) (pixel >> 16)
+    );
+  }
+
+  length += strlcpy_P(buffer + length, PSTR("]}"), sizeof(buffer) - length);
+  Server.sendContent(buffer, length);
+  Server.sendContent("");
 }
 
+
 // =---------------------------------------------------------------------------= Setup and Loop =--=
 
 void setupRandom() {
@@ -660,6 +3009,7 @@ void setup() {
   Serial.begin(115200);
   delay(100);
   Serial.println(""); // ESP8266 spits gibberish on reset, push actual output down
+  setupStallDetector();
 
   // Change Watchdog Timer to longer wait
   ESP.wdtDisable();
@@ -667,20 +3017,19 @@ void setup() {
 
   setupFilesystem();
   setupDisplay();
+#ifdef BENCHMARK
+  setupBenchmark();
+#endif
   setupPortal();
+  setupPreview();
   setupOTA();
   setupClock();
   setupRandom();
+
+  // Modem sleep only saves anything while the loop is idle in delay()
+  WiFi.setSleepMode(WIFI_MODEM_SLEEP);
 }
 
 void loop() {
-  loopPortal();
-  loopOTA();
-  if (WiFi.status() == WL_CONNECTED) {
-    if (!otaInProgress) {
-      surpriseAndDelight();
-      loopDisplay();
-    }
-    loopClock();
-  }
+  loopScheduler();
 }
@@ -9,10 +9,12 @@
 #include <ESP8266mDNS.h>
 #include <ESP8266WebServer.h>
 #include <ArduinoOTA.h>
-#include <NTPClient.h>
+#include <lwip/dns.h>
+#include <lwip/udp.h>
 #include <TimeLib.h>
-#include <Timezone.h>
 #include <AutoConnect.h>
+#include <WebSocketsServer.h>
+#include <TimezoneRules.h>
 
 
 // =--------------------------------------------------------------------------------= Constants =--=
@@ -20,22 +22,101 @@
 #define CONFIG_FILE                               "/settings.json"
 
 #define LED_PIN                                   15
-#define MATRIX_WIDTH                              29
-#define MATRIX_HEIGHT                             12
+
+// Panel geometry, everything else about the layout is generated from these
+#define DIGIT_COUNT                               4
+#define SEGMENT_STRIPS                            2 // strips per segment
+#define SEGMENT_LEDS_PER_STRIP                    3
+#define COLON_PLACES                              0b0010 // bit n: colon to the left of digit n
+
+#define SEGMENT_COUNT                             7
+#define COLON_COUNT                               __builtin_popcount(COLON_PLACES)
+#define DIGIT_WIDTH                               (2 * SEGMENT_STRIPS + SEGMENT_LEDS_PER_STRIP)
+#define DIGIT_LEDS                                (SEGMENT_COUNT * SEGMENT_STRIPS * SEGMENT_LEDS_PER_STRIP)
+#define MATRIX_WIDTH                              (DIGIT_COUNT * DIGIT_WIDTH + COLON_COUNT)
+#define MATRIX_HEIGHT                             (3 * SEGMENT_STRIPS + 2 * SEGMENT_LEDS_PER_STRIP)
 #define NUM_LEDS                                  (MATRIX_WIDTH * MATRIX_HEIGHT)
-#define LAST_VISIBLE_LED                          347
-#define CLOCK_UPDATE_MS                           1000
-#define ANIMATION_UPDATE_MS                       66 // 15fps
+#define NUM_PHYSICAL_LEDS                         (DIGIT_COUNT * DIGIT_LEDS + 2 * COLON_COUNT)
+#define LAST_VISIBLE_LED                          (NUM_PHYSICAL_LEDS - 1)
+#define WS2812_US_PER_LED                         30 // 24 bits at 800kHz
+#define CLOCK_UPDATE_MS                           1000 // until the first sync, then on every second edge
+#define FRAME_SECOND_EDGE                         0  // frame period for programs drawn on each second edge
+#define FRAME_EDGE_GUARD_US                       5000 // woken this close before an edge, wait for it
+#define ANIMATION_UPDATE_MS                       66 // 15fps, the frame length plasma speed was tuned at
+#define PLASMA_UPDATE_MS                          33 // 30fps
+#define STREAM_UPDATE_MS                          16 // 60fps, how often the socket is read
+#define STREAM_PORT                               4048 // DDP
+#define STREAM_SLOTS                              3  // one frame assembling and up to two waiting
+#define STREAM_TIMEOUT_MS                         2500 // show the clock when no packets come for this long
+#define STREAM_MAX_PACKETS                        16 // read per frame, the rest wait for the next one
+#define FRAME_STATS_WINDOW_MS                     1000 // window the achieved frame rate is averaged over
+#define RAIN_UPDATE_MS                            33 // 30fps
+#define RAIN_SPAWNS_PER_SECOND                    5
+#define RAIN_SPEED_MIN                            10 // rows per second
+#define RAIN_SPEED_MAX                            24
+#define RAIN_TRAIL_MIN                            4  // rows behind the head
+#define RAIN_TRAIL_MAX                            10
+#define TRANSITION_MS                             1000 // length of a crossfade or wipe between programs
+#define TRANSITION_UPDATE_MS                      16 // 60fps
+#define RAINBOW_UPDATE_MS                         16 // 60fps
+#define FIRE_UPDATE_MS                            33 // 30fps
+#define FIRE_LATTICE_STEP                         3  // pixels between cached noise samples
+#define FIRE_LATTICE_WIDTH                        ((MATRIX_WIDTH - 1) / FIRE_LATTICE_STEP + 2)
+#define FIRE_LATTICE_HEIGHT                       ((MATRIX_HEIGHT - 1) / FIRE_LATTICE_STEP + 2)
+#define RIPPLE_UPDATE_MS                          33 // 30fps
+#define RIPPLE_RING_DELTA                         20 // palette steps per pixel, a rainbow every 13 pixels
+
+#define PORTAL_UPDATE_MS                          20 // how often web and DNS requests are serviced
+#define OTA_UPDATE_MS                             50
+#define SURPRISE_UPDATE_MS                        1000
+#define SCHEDULER_FALLBACK_MS                     20 // retry for self-scheduling tasks that didn't set a deadline
+#define SCHEDULER_STATS_WINDOW_MS                 1000 // window busy time is averaged over
+#define SCHEDULER_REPORT_MS                       60000
+#define METRICS_CHUNK_SIZE                        512 // bytes of /metrics text buffered per chunk sent
+#define STALL_RTC_OFFSET                          32 // in 4 byte blocks, the first 128 bytes hold eboot's OTA command
+#define STALL_MAGIC                               0x5741A11E
+#define STALL_MAX_DEPTH                           4  // nested stages whose enclosing breadcrumb is put back
+#define EVENTS_MAX_CLIENTS                        4 // open /api/events streams, each holds a TCP connection
+#define EVENTS_UPDATE_MS                          1000
+#define EVENTS_STALL_MS                           10000 // a stream whose socket takes nothing this long is dropped
+#define PREVIEW_PORT                              81
+#define PREVIEW_MAX_VIEWERS                       2  // each keeps a copy of the frame it was last sent
+#define PREVIEW_UPDATE_MS                         100 // fastest a viewer is sent frames, 10fps
+#define PREVIEW_STALL_MS                          5000 // a viewer whose socket takes nothing this long is dropped
+#define LOG_BUFFER_SIZE                           4096 // bytes of recent log kept for the UART and /log
+#define LOG_LINE_SIZE                             160
+#define LOG_DRAIN_MS                              10 // 115200 baud empties the 128 byte UART FIFO in 11 ms
 
 #define CHAR_DASH                                 16
 
 #define LUMINANCE                                 28
+#define DISPLAY_GAMMA_RED                         1.0f // 1.0 keeps the linear response the colors
+#define DISPLAY_GAMMA_GREEN                       1.0f // below were picked under, ~2.2 for
+#define DISPLAY_GAMMA_BLUE                        1.0f // perceptually even fades
+#define DISPLAY_WHITE_BALANCE                     TypicalLEDStrip
+#define DITHER_REFRESH_MS                         0  // re-send unchanged dim frames this often to move the dither, 0 never
+#define DITHER_VISIBLE_LEVELS                     32 // below this output level a fraction is visibly off
 
 #define MDNS_HOSTNAME                             "big-clock"
 #define CAPTIVE_PORTAL_BLINK_MS                   1000
 
-#define NTP_UPDATE_MS                             10 * 60 * 1000 // interval between NTP checks
 #define NTP_RETRY_MS                              5000 // Retry connection to NTP
+#define NTP_POLL_MIN                              6  // sync every 2^n seconds, 64 s while learning the drift
+#define NTP_POLL_MAX                              12 // up to 4096 s once it is known
+#define NTP_POLL_STABLE                           3  // syncs within NTP_POLL_TIGHT_US before polling less often
+#define NTP_POLL_TIGHT_US                         2000
+#define NTP_POLL_LOOSE_US                         20000 // an offset this big polls more often again
+#define NTP_STEP_US                               128000 // step rather than slew offsets bigger than this
+#define NTP_SLEW_PPM                              500 // fastest the clock is slewed, 0.5 ms per second
+#define NTP_FREQ_MAX_PPB                          500000 // crystal error the frequency estimate is limited to
+#define NTP_HISTORY_SIZE                          32 // syncs kept for /api/clock
+#define NTP_HISTORY_ENTRY_SIZE                    108 // longest /api/clock history entry, with its terminator
+#define NTP_LOCAL_PORT                            1337
+#define NTP_POLL_MS                               10 // state machine step while a query is out
+#define NTP_TIMEOUT_MS                            1500 // for DNS, and again for the replies
+#define NTP_OUTLIER_US                            50000 // replies this far from the median offset are discarded
+#define NTP_PACKET_SIZE                           48
+#define NTP_UNIX_EPOCH                            2208988800UL // 1900 to 1970 in seconds
 
 #define OTA_PUBKEY "-----BEGIN PUBLIC KEY-----\nMIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAtaQtsdcGeKc9FlHsOnYh\nv1g6Hdsu2+t3/m5AJeT9ZHRJXcrxBKE8SL3WFpAXW28PiW1aHvG7ZNLEgoWlF48G\nwuzoigyiKxB0le937FgV7jvkVDlRjyXN0CZyBNftLqn95LKIaUWmxrWx/a8IUj8l\nY3n7OpqK/17ip0S0UrX8CY3jCE5zf57t6fdB7OkQItJtBO6pcgwWjpwWL3Paur+X\nPn92cRaJaA6ZSheqpk01e9mRVxRUQ8G1zUCDHKyUXpMH5EwctL0ugegQKWLerxFr\nZSDvMA1x18UyrUQgu9Yirf/b3CbQfRyuY4wW5alrSDs0AYr1osegV2OsA+lJOWxJ\n2QIDAQAB\n-----END PUBLIC KEY-----"
 #define OTA_PORT                                  8266
@@ -44,48 +125,163 @@
 // =----------------------------------------------------------------------------------= Statics =--=
 
 /**
-* A 7-segment LED descriptor used to identify its starting LED address and the number of LEDs in
-* the digit.
-*/
-struct ledDescriptor_t {
-  uint16_t startingLedNumber;   // the address of the first LED in a digit
-  uint8_t  numStrips;            // number of strips per segment
-  uint8_t  ledsPerStrip;         // number of LEDs per strip
-};
+ * A run of consecutive LEDs on the chain, one strip of one segment
+ */
+typedef struct {
+  uint16_t start;               // the address of the first LED in the run
+  uint16_t length;              // number of LEDs in the run
+} LedSpan_t;
 
-// Display Layout and Pixels
-static struct ledDescriptor_t descriptors[] = {
-  {  0, 2, 3}, // __:_X
-  { 42, 2, 3}, // __:X_
-  { 86, 2, 3}, // _X:__ -- skip colon pixels
-  {128, 2, 3}  // X_:__
-};
+/**
+ * A matrix cell that has an LED, packed into one flash word
+ */
+typedef struct {
+  uint8_t  x;
+  uint8_t  y;
+  uint16_t led;                 // address on the chain, always <= LAST_VISIBLE_LED
+} VisiblePixel_t;
 
-static const uint16_t colon1 = 84;  // the address of the first colon LED
-static const uint16_t colon2 = 85;  // the address of the second colon LED
+/**
+ * @brief Everything the firmware needs to know about where the LEDs are
+ *
+ * Generated at compile time by makePanelLayout() from the panel geometry constants and stored in
+ * flash, read with pgm_read_*.
+ *
+ * The X-Y map lets us treat the clock as a full matrix instead of the strip array + safety pixel so
+ * we can use animations that rely on surrounding pixel data and copying from previous frames. The
+ * wired LEDs come first, every matrix cell without an LED is given a hidden address above
+ * LAST_VISIBLE_LED in row-major order.
+ */
+typedef struct {
+  uint16_t  xy[NUM_LEDS];                                       // matrix cell to LED address
+  uint8_t   visible[(NUM_LEDS + 7) / 8];                        // bit per matrix cell with an LED
+  VisiblePixel_t pixels[NUM_PHYSICAL_LEDS];                     // cells with an LED, row-major
+  LedSpan_t segments[DIGIT_COUNT][SEGMENT_COUNT][SEGMENT_STRIPS]; // digit segment to LED runs
+  uint16_t  colons[COLON_COUNT > 0 ? COLON_COUNT : 1][2];       // upper and lower colon dots
+} PanelLayout_t;
 
-// Matrix mapping
 /**
- * @brief X-Y Matrix to LED strip mapping table
+ * @brief Matrix position of one LED of a digit segment
  *
- * This crazy thing let's us map a full X-Y matrix to the actual clock pixels. We use a full matrix
- * instead of the strip array + safety pixel so we can use animations that rely on surrounding pixel
- * data and copying from previous frames.
+ * Each segment is SEGMENT_STRIPS parallel strips snaking around the digit, the even strips run the
+ * segments 0-6 and the odd strips come back 6-0 in the opposite direction. Digits are
+ * DIGIT_WIDTH columns: the left vertical strips, the horizontal runs, then the right vertical
+ * strips, with the horizontal bars taking SEGMENT_STRIPS rows each.
+ *
+ * @param segment The segment of the digit, see the font for numbering.
+ * @param strip The strip within the segment.
+ * @param led The LED within the strip, in chain order.
+ * @param x Column offset from the left edge of the digit.
+ * @param y Row of the LED.
  */
-static const uint16_t XYTable[] = {
-  170, 171, 133, 132, 131, 172, 173, 174, 175,  91,  90,  89, 176, 177, 178, 179, 180,  47,  46,  45, 181, 182, 183, 184,   5,   4,   3, 185, 186,
-  187, 188, 164, 165, 166, 189, 190, 191, 192, 122, 123, 124, 193, 194, 195, 196, 197,  78,  79,  80, 198, 199, 200, 201,  36,  37,  38, 202, 203,
-  134, 163, 204, 205, 206, 167, 130,  92, 121, 207, 208, 209, 125,  88, 210,  48,  77, 211, 212, 213,  81,  44,   6,  35, 214, 215, 216,  39,   2,
-  135, 162, 217, 218, 219, 168, 129,  93, 120, 220, 221, 222, 126,  87,  84,  49,  76, 223, 224, 225,  82,  43,   7,  34, 226, 227, 228,  40,   1,
-  136, 161, 229, 230, 231, 169, 128,  94, 119, 232, 233, 234, 127,  86, 235,  50,  75, 236, 237, 238,  83,  42,   8,  33, 239, 240, 241,  41,   0,
-  242, 243, 160, 159, 158, 244, 245, 246, 247, 118, 117, 116, 248, 249, 250, 251, 252,  74,  73,  72, 253, 254, 255, 256,  32,  31,  30, 257, 258,
-  259, 260, 137, 138, 139, 261, 262, 263, 264,  95,  96,  97, 265, 266, 267, 268, 269,  51,  52,  53, 270, 271, 272, 273,   9,  10,  11, 274, 275,
-  149, 148, 276, 277, 278, 140, 157, 107, 106, 179, 280, 281,  98, 115, 282,  63,  62, 283, 284, 285,  54,  71,  21,  20, 286, 287, 288,  12,  29,
-  150, 147, 289, 290, 291, 141, 156, 108, 105, 292, 293, 294,  99, 114,  85,  64,  61, 295, 296, 297,  55,  70,  22,  19, 298, 299, 300,  13,  28,
-  151, 146, 301, 302, 303, 142, 155, 109, 104, 304, 305, 306, 100, 113, 307,  65,  60, 308, 309, 310,  56,  69,  23,  18, 311, 312, 313,  14,  27,
-  314, 315, 145, 144, 143, 316, 317, 318, 319, 103, 102, 101, 320, 321, 322, 323, 324,  59,  58,  57, 325, 326, 327, 328,  17,  16,  15, 329, 330,
-  331, 332, 152, 153, 154, 333, 334, 335, 336, 110, 111, 112, 337, 338, 339, 340, 341,  66,  67,  68, 342, 343, 344, 345,  24,  25,  26, 346, 347
-};
+constexpr void segmentPosition(uint8_t segment, uint8_t strip, uint8_t led, uint8_t &x, uint8_t &y) {
+  // Direction of travel for the even strips, odd strips run the other way
+  //                         0   1   2   3   4   5   6
+  const int8_t  dx[] =     { 0, -1,  0,  1,  0, -1,  0 };
+  const int8_t  dy[] =     {-1,  0,  1,  0,  1,  0, -1 };
+  const uint8_t S = SEGMENT_STRIPS, L = SEGMENT_LEDS_PER_STRIP, W = DIGIT_WIDTH;
+  const uint8_t upper = S, lower = 2 * S + L;
+  const uint8_t column[] = { uint8_t(W - 1 - strip), 0, strip, 0, uint8_t(W - S + strip), 0, uint8_t(S - 1 - strip) };
+  const uint8_t row[] = { upper, strip, upper, uint8_t(S + L + S - 1 - strip), lower, uint8_t(2 * S + 2 * L + strip), lower };
+
+  int8_t step = strip % 2 ? -1 : 1;
+  uint8_t offset = (dx[segment] + dy[segment]) * step > 0 ? led : L - 1 - led;
+
+  if (dx[segment]) {
+    x = S + offset;
+    y = row[segment];
+  } else {
+    x = column[segment];
+    y = row[segment] + offset;
+  }
+}
+
+constexpr PanelLayout_t makePanelLayout() {
+  PanelLayout_t layout = {};
+  for (uint16_t cell = 0; cell < NUM_LEDS; cell++) layout.xy[cell] = 0xFFFF;
+
+  uint16_t address = 0;
+  uint8_t left = MATRIX_WIDTH;
+  uint8_t colon = 0;
+
+  // Digits are chained right to left, starting with the least significant place
+  for (uint8_t place = 0; place < DIGIT_COUNT; place++) {
+    left -= DIGIT_WIDTH;
+
+    for (uint8_t strip = 0; strip < SEGMENT_STRIPS; strip++) {
+      for (uint8_t n = 0; n < SEGMENT_COUNT; n++) {
+        uint8_t segment = strip % 2 ? SEGMENT_COUNT - 1 - n : n;
+        layout.segments[place][segment][strip] = { address, SEGMENT_LEDS_PER_STRIP };
+
+        for (uint8_t led = 0; led < SEGMENT_LEDS_PER_STRIP; led++) {
+          uint8_t x = 0, y = 0;
+          segmentPosition(segment, strip, led, x, y);
+          layout.xy[y * MATRIX_WIDTH + left + x] = address++;
+        }
+      }
+    }
+
+    // Colon dots sit mid-way down the upper and lower vertical segments
+    if ((COLON_PLACES >> place) & 1) {
+      left -= 1;
+      const uint8_t rows[] = {
+        SEGMENT_STRIPS + SEGMENT_LEDS_PER_STRIP / 2,
+        2 * SEGMENT_STRIPS + SEGMENT_LEDS_PER_STRIP + SEGMENT_LEDS_PER_STRIP / 2
+      };
+      for (uint8_t dot = 0; dot < 2; dot++) {
+        layout.colons[colon][dot] = address;
+        layout.xy[rows[dot] * MATRIX_WIDTH + left] = address++;
+      }
+      colon++;
+    }
+  }
+
+  // Everything left over is padding, handed out in row-major order
+  uint16_t pixel = 0;
+  for (uint16_t cell = 0; cell < NUM_LEDS; cell++) {
+    if (layout.xy[cell] == 0xFFFF) {
+      layout.xy[cell] = address++;
+    } else {
+      layout.visible[cell / 8] |= 1 << (cell % 8);
+      layout.pixels[pixel++] = {
+        uint8_t(cell % MATRIX_WIDTH), uint8_t(cell / MATRIX_WIDTH), layout.xy[cell]
+      };
+    }
+  }
+
+  return layout;
+}
+
+static constexpr PanelLayout_t PanelLayout PROGMEM = makePanelLayout();
+
+constexpr bool isPanelPermutation(const PanelLayout_t &layout) {
+  bool seen[NUM_LEDS] = {};
+  for (uint16_t cell = 0; cell < NUM_LEDS; cell++) {
+    uint16_t address = layout.xy[cell];
+    if (address >= NUM_LEDS || seen[address]) return false;
+    seen[address] = true;
+  }
+  return true;
+}
+
+constexpr uint16_t countPanelVisible(const PanelLayout_t &layout) {
+  uint16_t count = 0;
+  for (uint16_t cell = 0; cell < NUM_LEDS; cell++) {
+    bool visible = (layout.visible[cell / 8] >> (cell % 8)) & 1;
+    if (visible != (layout.xy[cell] <= LAST_VISIBLE_LED)) return 0xFFFF;
+    if (visible) {
+      const VisiblePixel_t &pixel = layout.pixels[count];
+      if (pixel.y * MATRIX_WIDTH + pixel.x != cell || pixel.led != layout.xy[cell]) return 0xFFFF;
+      count++;
+    }
+  }
+  return count;
+}
+
+static_assert(MATRIX_WIDTH <= 255 && MATRIX_HEIGHT <= 255, "Matrix coordinates must fit a byte");
+static_assert(sizeof(VisiblePixel_t) == 4, "Visible pixels are read from flash as one word");
+static_assert(isPanelPermutation(PanelLayout), "X-Y map must use every LED address exactly once");
+static_assert(countPanelVisible(PanelLayout) == NUM_PHYSICAL_LEDS, "Visible mask must match the wired LEDs");
 
 // Colors
 static const CHSV colorOrange           = CHSV( 35, 255, 255);
@@ -97,127 +293,233 @@ static const CHSV colorCyan             = CHSV(131, 255, 255);
 static const CHSV colorHour             = colorBeige;
 static const CHSV colorColon            = colorOcean;
 static const CHSV colorMinute           = colorBeige;
+static const CHSV colorSecond           = colorBeige;
 
 
 // =---------------------------------------------------------------------------------= Programs =--=
 
-void setProgram(uint8_t program);
-void programClock(bool first);
-void programMatrix(bool first);
-void programRainbow(bool first);
-void programFire(bool first);
-void programPlasma(bool first);
+void renderRainbow(uint32_t time);
+void loadPaletteLut(const CRGBPalette16 &palette);
+void renderFire(uint32_t time);
+void loadRainbowLut();
+void renderPlasma(uint32_t time);
+void renderRipple(uint32_t time);
+/**
+ * Timing handed to a program for each frame, so it can animate by time instead of by frame count
+ */
+typedef struct {
+  bool     first;               // first frame since the program was started
+  uint32_t nowMs;               // millis() at the start of the frame
+  uint32_t elapsedMs;           // time since this program's previous frame, 0 on the first
+  uint32_t index;               // frames rendered since the program was started
+} FrameContext_t;
+
+/**
+ * Pacing statistics for the frame clock
+ */
+typedef struct {
+  uint32_t frames;              // frames rendered in total
+  uint32_t lateFrames;          // frames that started more than a whole period after their deadline
+  uint32_t worstFrameUs;        // longest render and present
+  uint16_t achievedFps10;       // frame rate over the last window, in tenths
+  uint16_t windowFrames;        // frames so far in the current window
+  uint32_t windowStartMs;
+  uint32_t edgeErrorUs;         // how long after the second edge the last edge aligned frame started
+  uint32_t edgeErrorMaxUs;
+} FrameStats_t;
 
-void (*renderFunc[])(bool first) {
+void programClock(const FrameContext_t &context);
+void programMatrix(const FrameContext_t &context);
+void programRainbow(const FrameContext_t &context);
+void programFire(const FrameContext_t &context);
+void programPlasma(const FrameContext_t &context);
+void programRipple(const FrameContext_t &context);
+void programStream(const FrameContext_t &context);
+
+void (*renderFunc[])(const FrameContext_t &context) {
   programClock,
   programMatrix,
   programRainbow,
   programFire,
-  programPlasma
+  programPlasma,
+  programRipple,
+  programStream
 };
 #define PROGRAM_COUNT (sizeof(renderFunc) / sizeof(renderFunc[0]))
+#define PROGRAM_STREAM 6 // shows pixels sent over the network, never picked at random
+
+/**
+ * @brief Falling code for the matrix program, at most one drop per column
+ *
+ * Kept as parallel arrays indexed by column, a drop is active while its trail is still on screen.
+ */
+typedef struct {
+  uint16_t head[MATRIX_WIDTH];  // head row, 8.8 fixed point
+  uint16_t speed[MATRIX_WIDTH]; // rows per second, 8.8 fixed point
+  uint8_t  trail[MATRIX_WIDTH]; // trail length in rows, 0 when the column has no drop
+  uint8_t  drops;               // number of active drops
+} MatrixRain_t;
+
+// Programs that draw palette indices into indexedLeds instead of colors into leds
+const bool programIndexed[] = {
+  false,
+  false,
+  true,
+  true,
+  true,
+  true,
+  false
+};
+static_assert(sizeof(programIndexed) == PROGRAM_COUNT, "Every program needs a framebuffer mode");
+
+// Frame period each program is paced at by the frame clock
+const uint16_t programFrameMs[] = {
+  FRAME_SECOND_EDGE,
+  RAIN_UPDATE_MS,
+  RAINBOW_UPDATE_MS,
+  FIRE_UPDATE_MS,
+  PLASMA_UPDATE_MS,
+  RIPPLE_UPDATE_MS,
+  STREAM_UPDATE_MS
+};
+static_assert(sizeof(programFrameMs) / sizeof(programFrameMs[0]) == PROGRAM_COUNT, "Every program needs a frame rate");
+
+/**
+ * @brief DDP packet header, the optional timecode is read separately when flagged
+ *
+ * All multi-byte fields are big endian.
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t  flags;               // version in the top two bits, then timecode, storage, reply, query, push
+  uint8_t  sequence;            // low nibble, 1-15 and wrapping, 0 when the sender doesn't number packets
+  uint8_t  dataType;
+  uint8_t  destination;         // 1 is the default output, 246 and up are control and status
+  uint8_t  offset[4];           // byte offset of the data into the frame
+  uint8_t  length[2];           // bytes of data following the header
+} DdpHeader_t;
+static_assert(sizeof(DdpHeader_t) == 10, "DDP headers are 10 bytes");
+
+#define DDP_VERSION_MASK                          0xC0
+#define DDP_VERSION_1                             0x40
+#define DDP_FLAG_TIMECODE                         0x10
+#define DDP_FLAG_QUERY                            0x02
+#define DDP_FLAG_PUSH                             0x01
+#define DDP_DESTINATION_CONTROL                   246
+
+/**
+ * @brief Jitter buffer for frames arriving over the network
+ *
+ * While no frame is waiting, packets are read from the socket straight into `leds` and a push only
+ * marks the frame done. A frame arriving before the last one was drawn is assembled in a slot
+ * instead, and the program takes the oldest complete slot on each of its frames. Slots form a ring,
+ * the frames waiting are the readyCount slots before the one assembling. They are only allocated
+ * while the stream program runs.
+ */
+typedef struct {
+  CRGB   (*slots)[NUM_PHYSICAL_LEDS]; // STREAM_SLOTS frames on the heap, see stopStream()
+  uint32_t completedUs[STREAM_SLOTS]; // micros() when each slot's push arrived
+  uint32_t directUs;            // micros() when the frame built in leds was pushed
+  uint8_t  assembling;          // slot packets are read into when they can't go to leds
+  uint8_t  readyCount;          // complete frames waiting to be shown
+  bool     partial;             // the assembling slot holds part of a frame
+  bool     pushedDirect;        // a frame was completed in leds and not drawn yet
+  uint8_t  lastSequence;        // of the last packet accepted, 0 for none
+  uint32_t lastPacketMs;
+  bool     fallback;            // showing the clock because the stream stopped
+} StreamBuffer_t;
+
+/**
+ * Counters for the stream program
+ */
+typedef struct {
+  uint32_t packets;             // accepted and read into a slot
+  uint32_t frames;              // completed by a push
+  uint32_t shown;               // taken from the jitter buffer and drawn
+  uint32_t duplicates;          // sequence number seen just before
+  uint32_t late;                // sequence number behind the last one accepted
+  uint32_t overruns;            // complete frames dropped because both waiting slots were full
+  uint32_t malformed;           // wrong version, short, or out of range
+  uint32_t fallbacks;           // times the stream stopped and the clock took over
+  uint16_t packetsPerSecond;    // over the last second
+  uint16_t windowPackets;
+  uint32_t windowStartMs;
+} StreamStats_t;
+
+void stopStream();
 
 const char *programNames[] = {
   "clock",
   "matrix",
   "rainbow",
   "fire",
-  "plasma"
+  "plasma",
+  "ripple",
+  "stream"
 };
 
 // =-------------------------------------------------------------------------------= Filesystem =--=
 
 void loadConfig();
-void saveConfig(String timezone);
+void saveConfig(const char *timezone);
 
 
 // =-------------------------------------------------------------------------------= Time Zones =--=
 
-// New Zealand Time Zone
-TimeChangeRule tzNewZealandSTD = {"NZST", First, Sun, Apr, 3, 720};   // UTC + 12 hours
-TimeChangeRule tzNewZealandDST = {"NZDT", Last, Sun, Sep, 2, 780};    // UTC + 13 hours
-Timezone tzNewZealand(tzNewZealandDST, tzNewZealandSTD);
-
-// Australia Eastern Time Zone (Sydney, Melbourne)
-TimeChangeRule tzAustraliaEDT = {"AEDT", First, Sun, Oct, 2, 660};
-TimeChangeRule tzAustraliaEST = {"AEST", First, Sun, Apr, 3, 600};
-Timezone tzAustraliaET(tzAustraliaEDT, tzAustraliaEST);
+// Compiled from the IANA database by bin/tzdb-compile and uploaded with the filesystem image, the
+// records themselves and their daylight saving rules are in lib/TimezoneRules
+#define TZDB_FILE                                 "/tzdb.bin"
+#define TZDB_MAGIC                                0x42445A54 // "TZDB"
+#define TZDB_VERSION                              1
 
-// Moscow Standard Time (MSK, does not observe DST)
-TimeChangeRule tzEuropeMoscow = {"MSK", Last, Sun, Mar, 1, 180};
-Timezone tzEuropeMSK(tzEuropeMoscow);
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint16_t count;               // records, sorted by case-folded name
+  uint16_t reserved;
+} TzdbHeader_t;
 
-// United Kingdom (London, Belfast)
-TimeChangeRule tzEuropeBST = {"BST", Last, Sun, Mar, 1, 60};
-TimeChangeRule tzEuropeGMT = {"GMT", Last, Sun, Oct, 2, 0};
-Timezone tzEuropeUK(tzEuropeBST, tzEuropeGMT);
+// Used until a zone is loaded, and for good when the database is missing
+static const Timezone_t TZ_UTC = { "Etc/UTC", "UTC", "", 0, 0, {}, {}, 0, {} };
 
-// UTC
-TimeChangeRule utcRule = {"UTC", Last, Sun, Mar, 1, 0};
-Timezone tzUTC(utcRule);
+bool openTzdb(File &tzdb, TzdbHeader_t &header);
+bool readTimezone(File &tzdb, const TzdbHeader_t &header, uint16_t index, Timezone_t &zone);
+bool findTimezone(const char *name, Timezone_t &zone);
 
-// US Eastern Time Zone (New York, Detroit)
-TimeChangeRule tzAmericaEDT = {"EDT", Second, Sun, Mar, 2, -240};
-TimeChangeRule tzAmericaEST = {"EST", First, Sun, Nov, 2, -300};
-Timezone tzAmericaET(tzAmericaEDT, tzAmericaEST);
 
-// US Central Time Zone (Chicago, Houston)
-TimeChangeRule tzAmericaCDT = {"CDT", Second, Sun, Mar, 2, -300};
-TimeChangeRule tzAmericaCST = {"CST", First, Sun, Nov, 2, -360};
-Timezone tzAmericaCT(tzAmericaCDT, tzAmericaCST);
-
-// US Mountain Time Zone (Denver, Salt Lake City)
-TimeChangeRule tzAmericaMDT = {"MDT", Second, Sun, Mar, 2, -360};
-TimeChangeRule tzAmericaMST = {"MST", First, Sun, Nov, 2, -420};
-Timezone tzAmericaMT(tzAmericaMDT, tzAmericaMST);
-
-// Arizona is US Mountain Time Zone but does not use DST
-Timezone tzAmericaAZ(tzAmericaMST);
-
-// US Pacific Time Zone (Las Vegas, Los Angeles)
-TimeChangeRule tzAmericaPDT = {"PDT", Second, Sun, Mar, 2, -420};
-TimeChangeRule tzAmericaPST = {"PST", First, Sun, Nov, 2, -480};
-Timezone tzAmericaPT(tzAmericaPDT, tzAmericaPST);
-
-/**
- * Timezone struct to collect human readable name and the timezone object with daylight saving rules
- */
-typedef struct {
-  const char* name;
-  Timezone    timezone;
-} Timezone_t;
+// =---------------------------------------------------------------------------= Captive Portal =--=
 
-/**
- * Complete listing of timezones that can be selected in the portal UI
- */
-static const Timezone_t TZ_LIST[] = {
-  { "Pacific/New Zealand", tzNewZealand },
-  // { "Pacific/Noumea", 11 },
-  { "Australia/Sydney", tzAustraliaET },
-  // { "Asia/Tokyo", 9 },
-  // { "Asia/Manila", 8 },
-  // { "Asia/Jakarta", 7 },
-  // { "Asia/Dhaka", 6 },
-  // { "Asia/Karachi", 5 },
-  // { "Asia/Dubai", 4 },
-  { "Europe/Moscow", tzEuropeMSK },
-  // { "Europe/Helsinki", 2 },
-  // { "Europe/Berlin", 1 },
-  { "UTC", tzUTC },
-  { "Europe/London", tzEuropeUK },
-  // { "Atlantic/Azores", -1 },
-  // { "America/Noronha", -2 },
-  // { "America/Araguaina", -3 },
-  { "America/Eastern", tzAmericaET },
-  { "America/Central", tzAmericaCT },
-  { "America/Mountain", tzAmericaMT },
-  { "America/Arizone", tzAmericaAZ },
-  { "America/Pacific", tzAmericaPT }
-  // { "Pacific/Samoa", -11 },
-};
+// Status page, served in two halves around the current time
+static const char PORTAL_ROOT_PAGE_HEAD[] PROGMEM =
+  "<html>"
+  "<head>"
+  "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">"
+  "</head>"
+  "<body>"
+  "<h2 align=\"center\" style=\"color:black;margin:20px;\">Big Clock</h2>"
+  "<h3 id=\"time\" align=\"center\" style=\"color:gray;margin:10px;\">";
 
+// The time is kept current from /api/events instead of reloading the page
+static const char PORTAL_ROOT_PAGE_TAIL[] PROGMEM =
+  "</h3>"
+  "<p></p><p style=\"padding-top:15px;text-align:center\">" AUTOCONNECT_LINK(COG_24) "</p>"
+  "<script type=\"text/javascript\">"
+  "new EventSource(\"/api/events\").onmessage = function(event) {"
+  "var status = JSON.parse(event.data);"
+  "document.getElementById(\"time\").textContent ="
+  " status.synced ? status.time + \", \" + status.timezone : \"Waiting for NTP sync\";"
+  "};"
+  "</script>"
+  "</body>"
+  "</html>";
 
-// =---------------------------------------------------------------------------= Captive Portal =--=
+static const char PORTAL_EVENTS_HEADER[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Connection: keep-alive\r\n"
+  "Access-Control-Allow-Origin: *\r\n"
+  "\r\n";
 
 static const char PORTAL_CONFIGURE_PAGE[] PROGMEM = R"(
 {
@@ -233,9 +535,14 @@ static const char PORTAL_CONFIGURE_PAGE[] PROGMEM = R"(
     },
     {
       "name": "timezone",
-      "type": "ACSelect",
+      "type": "ACInput",
       "label": "Time Zone",
-      "option": []
+      "placeholder": "Europe/Berlin"
+    },
+    {
+      "name": "timezones",
+      "type": "ACElement",
+      "value": "<datalist id='timezones'></datalist><script>document.getElementById('timezone').setAttribute('list','timezones');fetch('/api/timezones').then(function(r){return r.text()}).then(function(t){var l=document.getElementById('timezones');t.split('\\n').forEach(function(n){if(n){var o=document.createElement('option');o.value=n;l.appendChild(o)}})})</script>"
     },
     {
       "name": "newline",
@@ -266,24 +573,224 @@ static const char PORTAL_CONFIGURE_PAGE[] PROGMEM = R"(
 
 // =----------------------------------------------------------------------------= NTP and Clock =--=
 
-void syncLocalClock();
+// Queried together on every sync, the answers are compared and the odd ones out ignored
+static const char *const NTP_SERVERS[] = {
+  "0.pool.ntp.org",
+  "1.pool.ntp.org",
+  "2.pool.ntp.org",
+  "time.cloudflare.com"
+};
+#define NTP_SERVER_COUNT                          (sizeof(NTP_SERVERS) / sizeof(NTP_SERVERS[0]))
+
+typedef enum : uint8_t {
+  NTP_IDLE,                     // between syncs
+  NTP_RESOLVING,                // waiting on DNS for the server addresses
+  NTP_WAITING                   // requests sent, collecting replies
+} NtpState_t;
+
+/**
+ * One NTP server and what it said last
+ */
+typedef struct {
+  IPAddress address;
+  bool      resolved;           // address set, by the DNS callback or from cache
+  bool      sent;               // request sent this round
+  bool      answered;           // valid reply received this round
+  bool      outlier;            // reply discarded this round for disagreeing with the others
+  uint64_t  originate;          // transmit timestamp of the request, echoed back by the server
+  uint64_t  sentUs;             // local clock when the request went out
+  int64_t   offsetUs;           // server clock minus local clock
+  uint32_t  rttUs;              // round trip, less the server's own processing time
+  uint8_t   stratum;
+  uint32_t  replies;
+  uint32_t  timeouts;
+} NtpServer_t;
+
+/**
+ * A reply as it came off the network, stamped with the local clock on arrival
+ */
+typedef struct {
+  uint8_t   packet[NTP_PACKET_SIZE];
+  IPAddress from;
+  uint64_t  receivedUs;         // local clock when lwIP handed it over
+} NtpReply_t;
+
+/**
+ * The SNTP state machine, stepped a little on each call to loopClock()
+ */
+typedef struct {
+  NtpState_t state;
+  uint32_t   phaseStartMs;      // when resolving or waiting started
+  uint32_t   rounds;            // syncs attempted
+  uint32_t   failures;          // syncs without a usable reply
+  uint32_t   tickUs;            // time spent in the last step
+  uint32_t   tickMaxUs;         // longest single step, what the loop pays for NTP at worst
+} NtpClient_t;
+
+/**
+ * @brief The local clock, micros64() corrected for the crystal's frequency error and slewed toward NTP
+ *
+ * Read as epochUs plus the time since baseMicros, scaled by freqPpb, plus as much of slewUs as
+ * NTP_SLEW_PPM allows for that time. Rebased to the current reading whenever it is adjusted.
+ */
+typedef struct {
+  uint64_t epochUs;             // clock reading at baseMicros, microseconds since 1970
+  uint64_t baseMicros;          // micros64() at the last rebase
+  int32_t  freqPpb;             // added to the rate of micros64(), parts per billion
+  int64_t  slewUs;              // correction still to be slewed in as of baseMicros
+  uint64_t sampleMicros;        // micros64() at the last NTP sample, 0 before the first
+  uint8_t  pollExponent;        // syncing every 2^n seconds
+  uint8_t  stable;              // consecutive samples within NTP_POLL_TIGHT_US
+} ClockDiscipline_t;
+
+/**
+ * One NTP sample as applied to the clock, for the history ring
+ */
+typedef struct {
+  uint32_t epoch;               // seconds since 1970 when taken
+  int32_t  offsetUs;            // measured offset, clamped to 32 bits
+  int32_t  freqPpb;             // frequency correction after it
+  uint8_t  pollExponent;        // poll interval after it
+  bool     stepped;             // offset was too large to slew
+} ClockSample_t;
+
+uint64_t localEpochUs();
+time_t clockNow();
+void rebaseClock();
+bool disciplineClock(int64_t offsetUs);
+void portalClockPage();
+void startNtpRound();
+void sendNtpRequests();
+void readNtpReplies();
+bool finishNtpRound();
+void onNtpHostFound(const char *name, const ip_addr_t *address, void *arg);
+void onNtpPacket(void *arg, udp_pcb *pcb, pbuf *p, const ip_addr_t *address, u16_t port);
 
 
 // =--------------------------------------------------------------------------= WiFi and Portal =--=
 
 void portalRootPage();
 void portalStartPage();
+void portalTimezonesPage();
+void fillStatus(JsonDocument &status);
+void portalStatusPage();
+void portalEventsPage();
+void pushEvents();
+
+/**
+ * A browser following /api/events
+ */
+typedef struct {
+  WiFiClient client;
+  uint32_t   writableMs;        // last time its socket had room for a message
+  uint32_t   skipped;           // messages skipped because its socket was still full
+} EventClient_t;
 bool loopCaptivePortal(void);
 bool startCaptivePortal(IPAddress& ip);
 void onWifiConnect(IPAddress& ipaddr);
 
 
+// =----------------------------------------------------------------------------------= Display =--=
+
+/**
+ * Counters for the present step that pushes the matrix out to the LED chain
+ */
+typedef struct {
+  uint32_t framesPresented;     // frames clocked out on the data line
+  uint32_t framesSkipped;       // frames identical to the last one presented, never sent
+  uint64_t wireTimeSavedUs;     // total interrupt-off time saved by padding and skipped frames
+  uint16_t ledsTouched;         // LEDs rewritten by the last clock tick
+  uint32_t framesDithered;      // unchanged frames re-sent only to advance the dither
+  uint64_t ditherWireUs;        // interrupt-off wire time spent on those
+  uint32_t outputUs;            // time spent mapping the last frame through the output table
+  uint32_t outputMaxUs;         // worst case of the above
+} DisplayStats_t;
+
+// Wire time not spent on the hidden matrix padding for every frame presented
+#define DISPLAY_WIRE_SAVED_US   ((NUM_LEDS - NUM_PHYSICAL_LEDS) * WS2812_US_PER_LED)
+
+// Wire time of one frame in whole milliseconds
+#define DISPLAY_SHOW_MS         ((NUM_PHYSICAL_LEDS * WS2812_US_PER_LED + 999) / 1000)
+
+static_assert(DITHER_REFRESH_MS == 0 || DITHER_REFRESH_MS >= 100, "Dither refreshes hold interrupts off, 10 a second at most");
+
+#define MATRIX_COLOR_BYTES      (NUM_LEDS * sizeof(CRGB))
+#define MATRIX_INDEXED_BYTES    NUM_LEDS
+#define MATRIX_FROZEN_BYTES     (NUM_PHYSICAL_LEDS * sizeof(CRGB))
+
+// A color matrix with an indexed one or a frozen color frame beside it, rounded up to whole words
+#define MATRIX_POOL_SIZE        \
+  ((MATRIX_COLOR_BYTES + (MATRIX_INDEXED_BYTES > MATRIX_FROZEN_BYTES ? MATRIX_INDEXED_BYTES : MATRIX_FROZEN_BYTES) + 3) & ~3)
+
+/**
+ * @brief A virtual matrix a program draws into
+ *
+ * There are two so a program switch can keep the outgoing program running while the incoming one
+ * starts. Both live in matrixPool, sized by what they hold, see placeMatrix(). `leds` and
+ * `indexedLeds` point into whichever one is being drawn. Indices are looked up in paletteLut, which
+ * only one live matrix at a time draws with.
+ */
+typedef struct {
+  uint8_t      *buffer;                 // colors, palette indices or a frozen frame, in matrixPool
+  bool          indexed;                // whether buffer holds colors or palette indices
+  bool          frozen;                 // only the wired LEDs of its last frame are kept
+  uint8_t       rotation;               // offset added to every index when the frame is presented
+  FrameContext_t context;               // timing of the last frame drawn into this matrix
+} Matrix_t;
+
+static_assert(MATRIX_COLOR_BYTES + MATRIX_INDEXED_BYTES <= MATRIX_POOL_SIZE, "Matrices overlap");
+static_assert(MATRIX_COLOR_BYTES + MATRIX_FROZEN_BYTES <= MATRIX_POOL_SIZE, "Matrices overlap");
+
+typedef enum {
+  TRANSITION_CUT,                       // switch on the next frame
+  TRANSITION_CROSSFADE,                 // fade the outgoing program into the incoming one
+  TRANSITION_WIPE                       // sweep the incoming program in from the left
+} TransitionStyle_t;
+
+/**
+ * A program switch in progress, blending the outgoing program's matrix into the incoming one
+ */
+typedef struct {
+  bool              active;
+  TransitionStyle_t style;
+  uint8_t           fromProgram;        // outgoing program, still rendering into fromMatrix
+  uint8_t           fromMatrix;
+  uint32_t          startMs;
+  uint16_t          durationMs;
+} Transition_t;
+
+// Byte-at-a-time kernels work on 32-bit words, allowed to alias any pixel buffer
+typedef uint32_t __attribute__((__may_alias__)) swar32_t;
+
+void setProgram(uint8_t program, TransitionStyle_t style = TRANSITION_CROSSFADE);
+void selectMatrix(uint8_t matrix);
+void placeMatrix(uint8_t matrix, bool indexed, bool frozen = false);
+void clearLeds();
+void setDisplayIndexed(bool indexed);
+void showDisplay(bool force = false);
+void setDisplayBrightness(uint8_t brightness);
+void writeOutput();
+void finishTransition();
+void blendBytes(uint8_t *out, const uint8_t *from, const uint8_t *to, uint16_t count, uint16_t amount);
+void fillLinearGradient(uint8_t startIndex, int8_t xDelta, int8_t yDelta);
+void fillRadialGradient(uint8_t startIndex, uint8_t centerX, uint8_t centerY, int8_t ringDelta);
+
+
 // =--------------------------------------------------------------------= Seven Segment Display =--=
 
-void writeDigit(uint8_t character, uint16_t place, CRGB color);
+/**
+ * What a digit currently shows in `leds`, so unchanged segments can be left alone
+ */
+typedef struct {
+  bool    valid;                // false when the LEDs may have been drawn over by something else
+  uint8_t segments;             // lit segment bits, as in the font
+  CRGB    color;                // color of the lit segments
+} DigitState_t;
+
+void invalidateDigits();
+uint16_t writeDigit(uint8_t character, uint16_t place, CRGB color);
 void writeAllDigits(uint8_t character, CRGB color);
-void writeSegment(uint16_t place, uint8_t segment, CRGB color);
-void writeSegmentStrip(uint16_t startingLed, uint16_t quantity, CRGB color); 
+uint16_t writeSegment(uint16_t place, uint8_t segment, CRGB color);
 
 /**
  * @brief A 7-Segment display 'font'.
@@ -368,3 +875,257 @@ static const uint8_t progressSegmentMap[] = {
   1, 5,
   0, 5
 };
+
+
+// =---------------------------------------------------------------------------------= Profiler =--=
+
+/**
+ * Loop stages timed on their own, programs' render and present steps are timed per program
+ */
+typedef enum : uint8_t {
+  PROFILE_PORTAL,               // Portal.handleClient(), including any page served
+  PROFILE_MDNS,
+  PROFILE_OTA,
+  PROFILE_SURPRISE,
+  PROFILE_NTP,
+  PROFILE_SHOW,                 // FastLED.show(), the wire time of a frame
+  PROFILE_RENDER,               // every program's render, also kept per program
+  PROFILE_PRESENT,              // every program's present, also kept per program
+  PROFILE_STAGE_COUNT
+} ProfileStage_t;
+
+const char *profileStageNames[] = {
+  "portal",
+  "mdns",
+  "ota",
+  "surprise",
+  "ntp",
+  "show",
+  "render",
+  "present"
+};
+static_assert(sizeof(profileStageNames) / sizeof(profileStageNames[0]) == PROFILE_STAGE_COUNT, "Every stage needs a name");
+
+// Upper bounds of the histogram buckets in microseconds, anything slower lands in a final overflow bucket
+static const uint32_t profileBucketUs[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000 };
+#define PROFILE_BUCKETS                           (sizeof(profileBucketUs) / sizeof(profileBucketUs[0]) + 1)
+
+/**
+ * Fixed bucket histogram of how long something took
+ */
+typedef struct {
+  uint32_t counts[PROFILE_BUCKETS]; // samples per bucket, not cumulative
+  uint32_t samples;
+  uint64_t sumUs;
+  uint32_t maxUs;
+} Histogram_t;
+
+/**
+ * Breadcrumbs kept in RTC user memory, which survives a watchdog or exception reset
+ */
+typedef struct {
+  uint32_t magic;               // STALL_MAGIC once written by this firmware
+  uint32_t uptimeMs;            // millis() when the stage was entered
+  uint32_t freeHeap;            // free heap when the stage was entered
+  uint32_t loopUs;              // busy time of the last complete scheduler pass
+  uint32_t loopMaxUs;           // worst case of the above
+  uint32_t longestUs;           // longest single stage since boot
+  uint8_t  stage;               // innermost stage still running, or the last one left at depth 0
+  uint8_t  program;             // program current, or rendered, in that stage
+  uint8_t  longestStage;
+  uint8_t  longestProgram;
+  uint8_t  depth;               // stages entered and not yet left, 0 when the loop was between stages
+  uint8_t  reserved[3];
+} StallRecord_t;
+static_assert(sizeof(StallRecord_t) % 4 == 0, "RTC memory is written in 4 byte blocks");
+
+void recordSample(Histogram_t &histogram, uint32_t us);
+void recordProfile(Histogram_t &histogram, uint32_t startUs);
+uint32_t beginStage(ProfileStage_t stage, uint8_t program);
+void endStage(ProfileStage_t stage, uint8_t program, uint32_t startUs);
+void setupStallDetector();
+void portalMetricsPage();
+void portalStallPage();
+
+
+// =--------------------------------------------------------------------------------= Scheduler =--=
+
+/**
+ * Everything the main loop runs, in table order
+ */
+typedef enum : uint8_t {
+  TASK_PORTAL,
+  TASK_OTA,
+  TASK_DISPLAY,
+  TASK_SURPRISE,
+  TASK_CLOCK,
+  TASK_REPORT,
+  TASK_LOG,
+  TASK_EVENTS,
+  TASK_PREVIEW,
+  TASK_COUNT
+} TaskId_t;
+
+/**
+ * A piece of work the main loop runs when its deadline comes up
+ */
+typedef struct {
+  const char *name;
+  void (*run)();
+  uint16_t periodMs;            // 0 for tasks that set their own deadline with scheduleTask()
+  uint8_t  priority;            // lower runs first when several tasks are due
+  uint32_t dueMs;               // millis() the task should next run at
+  uint32_t runs;
+  uint32_t lateMs;              // total time runs started after their deadline
+  uint32_t lateMaxMs;           // worst case of the above
+} Task_t;
+
+/**
+ * How much of the time the main loop spends working rather than sleeping
+ */
+typedef struct {
+  uint32_t busyUs;              // time spent in tasks in the current window
+  uint32_t windowStartUs;
+  uint16_t busyPermille;        // share of the last window spent in tasks
+} SchedulerStats_t;
+
+void taskDisplay();
+void taskSurprise();
+void taskClock();
+void reportScheduler();
+void scheduleTask(TaskId_t task, uint32_t dueMs);
+void loopScheduler();
+
+
+// =----------------------------------------------------------------------------------= Logging =--=
+
+#define LOG_LEVEL_NONE                            0
+#define LOG_LEVEL_ERROR                           1
+#define LOG_LEVEL_WARN                            2
+#define LOG_LEVEL_INFO                            3
+#define LOG_LEVEL_DEBUG                           4
+
+// Messages above this level are compiled out, format strings and all
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                                 LOG_LEVEL_INFO
+#endif
+
+// A compiled-out message still type checks its arguments and counts as using them, the dead branch
+// is dropped along with its format string
+#define LOG_DISCARD(format, ...)                  do { if (0) logPrintf(' ', format, ##__VA_ARGS__); } while (0)
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "The log ring wraps with a mask");
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...)                    logPrintf('E', PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...)                    LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...)                     logPrintf('W', PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...)                     LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...)                     logPrintf('I', PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...)                     LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...)                    logPrintf('D', PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...)                    LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+void logPrintf(char level, PGM_P format, ...);
+void drainLog();
+void flushLog();
+void portalLogPage();
+
+
+// =----------------------------------------------------------------------------------= Preview =--=
+
+/**
+ * A browser watching the LEDs over the preview WebSocket
+ */
+typedef struct {
+  bool     connected;
+  uint8_t  client;              // WebSocketsServer client number
+  bool     keyframe;            // send every LED next time, not just the changes
+  uint32_t connectedMs;
+  uint32_t lastSendMs;
+  uint32_t writableMs;          // last time its socket had room for a frame
+  uint32_t frames;              // messages sent
+  uint32_t skipped;             // frames skipped because its socket was still full
+  uint32_t bytes;               // payload bytes sent
+  uint32_t cpuUs;               // time spent encoding and sending
+  CRGB     sent[NUM_PHYSICAL_LEDS]; // the frame as this viewer last received it
+} PreviewViewer_t;
+
+// Worst case message, a keyframe: type byte and every LED
+#define PREVIEW_MESSAGE_SIZE                      (1 + 3 * NUM_PHYSICAL_LEDS)
+// WebSocket header of an unmasked binary frame up to 65535 bytes
+#define PREVIEW_FRAME_HEADER                      4
+
+/**
+ * The preview WebSocket server, which can also tell how much a viewer's socket takes without blocking
+ */
+class PreviewServer_t : public WebSocketsServer {
+public:
+  using WebSocketsServer::WebSocketsServer;
+  size_t writeSpace(uint8_t client);
+};
+
+/**
+ * @brief Preview page, draws the LEDs where they sit on the panel from /api/layout
+ *
+ * Messages from the socket are binary. 'K' is followed by every LED's RGB in chain order. 'D' is
+ * followed by runs of changed LEDs, each a 16 bit little endian start address, a count and that
+ * many RGB triples.
+ */
+static const char PREVIEW_PAGE[] PROGMEM = R"html(<html>
+<head>
+<meta name="viewport" content="width=device-width, initial-scale=1">
+<style>body{background:#111;color:#888;font-family:sans-serif;text-align:center}canvas{max-width:100%}</style>
+</head>
+<body>
+<h2>Big Clock</h2>
+<canvas id="panel"></canvas>
+<script type="text/javascript">
+var size = 16, canvas = document.getElementById("panel"), context = canvas.getContext("2d"), where = [];
+function draw(led, r, g, b) {
+  if (!where[led]) return;
+  context.fillStyle = "rgb(" + r + "," + g + "," + b + ")";
+  context.fillRect(where[led][0] * size + 1, where[led][1] * size + 1, size - 2, size - 2);
+}
+fetch("/api/layout").then(function(response) { return response.json(); }).then(function(layout) {
+  canvas.width = layout.width * size;
+  canvas.height = layout.height * size;
+  for (var n = 0; n < layout.pixels.length; n += 3) where[layout.pixels[n + 2]] = [layout.pixels[n], layout.pixels[n + 1]];
+  var socket = new WebSocket("ws://" + location.hostname + ":81/");
+  socket.binaryType = "arraybuffer";
+  socket.onmessage = function(event) {
+    var data = new Uint8Array(event.data), n = 1;
+    if (data[0] == 75) {
+      for (var led = 0; n < data.length; led++, n += 3) draw(led, data[n], data[n + 1], data[n + 2]);
+    } else {
+      while (n < data.length) {
+        var led = data[n] | data[n + 1] << 8, count = data[n + 2];
+        for (n += 3; count--; led++, n += 3) draw(led, data[n], data[n + 1], data[n + 2]);
+      }
+    }
+  };
+});
+</script>
+</body>
+</html>)html";
+
+void setupPreview();
+void loopPreview();
+void onPreviewEvent(uint8_t client, WStype_t type, uint8_t *payload, size_t length);
+size_t encodePreview(PreviewViewer_t &viewer, uint8_t *message);
+void portalPreviewPage();
+void portalLayoutPage();
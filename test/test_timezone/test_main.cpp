@@ -0,0 +1,62 @@
+// =-------------------------------------------------------------------------------= Time Zones =--=
+//
+// Runs the firmware's daylight saving rules on the host against zoneinfo, see bin/tzdb-compile.
+//
+//   bin/tzdb-compile --vectors
+//   pio test -e native
+
+#include <stdio.h>
+#include <unity.h>
+#include <TimezoneRules.h>
+
+/**
+ * The offset zoneinfo gives a zone at a moment
+ */
+typedef struct {
+  uint16_t zone;                // index into VECTOR_ZONES
+  int64_t  utc;
+  int16_t  offset;              // minutes east of UTC
+} TzVector_t;
+
+#include "vectors.h"
+
+#define VECTOR_COUNT                              (sizeof(VECTORS) / sizeof(VECTORS[0]))
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Rules whose changes fall on known dates, in week 5 both as the fifth and the fourth week
+ */
+void testRuleTime() {
+  const TzRule_t usStart = { 3, 2, 0, 0, 120 };    // second Sunday in March, 02:00
+  const TzRule_t euEnd = { 10, 5, 0, 0, 180 };     // last Sunday in October, 03:00
+  const TzRule_t late = { 1, 1, 0, 0, 24 * 60 };   // first Sunday in January, 24:00
+
+  TEST_ASSERT_EQUAL_INT64(1772935200, timezoneRuleTime(usStart, 2026)); // 2026-03-08 02:00
+  TEST_ASSERT_EQUAL_INT64(1792897200, timezoneRuleTime(euEnd, 2026));   // 2026-10-25 03:00, fourth Sunday
+  TEST_ASSERT_EQUAL_INT64(1824951600, timezoneRuleTime(euEnd, 2027));   // 2027-10-31 03:00, fifth Sunday
+  TEST_ASSERT_EQUAL_INT64(1767571200, timezoneRuleTime(late, 2026));    // 2026-01-04 24:00
+}
+
+/**
+ * @brief Every zone's offset either side of every change zoneinfo makes
+ */
+void testVectors() {
+  char message[96];
+
+  for (size_t n = 0; n < VECTOR_COUNT; n++) {
+    const TzVector_t &vector = VECTORS[n];
+    const Timezone_t &zone = VECTOR_ZONES[vector.zone];
+
+    snprintf(message, sizeof(message), "%s at %lld", zone.name, (long long) vector.utc);
+    TEST_ASSERT_EQUAL_INT64_MESSAGE(vector.offset * 60, toLocal(zone, vector.utc) - vector.utc, message);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(testRuleTime);
+  RUN_TEST(testVectors);
+  return UNITY_END();
+}
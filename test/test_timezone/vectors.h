@@ -0,0 +1,1340 @@
+// Generated by bin/tzdb-compile --vectors from tzdata 2025b for 2026-2035
+//
+// One zone for each distinct rule, and zoneinfo's offset in minutes on either side of every change
+// it makes in those years. Regenerate rather than edit.
+
+static const Timezone_t VECTOR_ZONES[] = {
+  { "Africa/Abidjan", "GMT", "", 0, 0, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Africa/Addis_Ababa", "EAT", "", 180, 180, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Africa/Algiers", "CET", "", 60, 60, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Africa/Blantyre", "CAT", "", 120, 120, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Africa/Cairo", "EET", "EEST", 120, 180, { 4, 5, 5, 0, 0 }, { 10, 5, 4, 0, 1440 }, 0x01, {} },
+  { "Africa/Ceuta", "CET", "CEST", 60, 120, { 3, 5, 0, 0, 120 }, { 10, 5, 0, 0, 180 }, 0x01, {} },
+  { "America/Adak", "HST", "HDT", -600, -540, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Anchorage", "AKST", "AKDT", -540, -480, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Anguilla", "AST", "", -240, -240, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Araguaina", "-03", "", -180, -180, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Atikokan", "EST", "", -300, -300, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Bahia_Banderas", "CST", "", -360, -360, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Boise", "MST", "MDT", -420, -360, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Chicago", "CST", "CDT", -360, -300, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Creston", "MST", "", -420, -420, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Detroit", "EST", "EDT", -300, -240, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Glace_Bay", "AST", "ADT", -240, -180, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Havana", "CST", "CDT", -300, -240, { 3, 2, 0, 0, 0 }, { 11, 1, 0, 0, 60 }, 0x01, {} },
+  { "America/Los_Angeles", "PST", "PDT", -480, -420, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Miquelon", "-03", "-02", -180, -120, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "America/Noronha", "-02", "", -120, -120, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "America/Nuuk", "-02", "-01", -120, -60, { 3, 5, 0, 0, -60 }, { 10, 5, 0, 0, 0 }, 0x01, {} },
+  { "America/Santiago", "-04", "-03", -240, -180, { 9, 1, 6, 0, 1440 }, { 4, 1, 6, 0, 1440 }, 0x01, {} },
+  { "America/St_Johns", "NST", "NDT", -210, -150, { 3, 2, 0, 0, 120 }, { 11, 1, 0, 0, 120 }, 0x01, {} },
+  { "Antarctica/Casey", "+08", "", 480, 480, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Antarctica/Davis", "+07", "", 420, 420, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Antarctica/DumontDUrville", "+10", "", 600, 600, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Antarctica/Macquarie", "AEST", "AEDT", 600, 660, { 10, 1, 0, 0, 120 }, { 4, 1, 0, 0, 180 }, 0x01, {} },
+  { "Antarctica/Mawson", "+05", "", 300, 300, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Antarctica/McMurdo", "NZST", "NZDT", 720, 780, { 9, 5, 0, 0, 120 }, { 4, 1, 0, 0, 180 }, 0x01, {} },
+  { "Antarctica/Troll", "+00", "+02", 0, 120, { 3, 5, 0, 0, 60 }, { 10, 5, 0, 0, 180 }, 0x01, {} },
+  { "Asia/Anadyr", "+12", "", 720, 720, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Baku", "+04", "", 240, 240, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Beirut", "EET", "EEST", 120, 180, { 3, 5, 0, 0, 0 }, { 10, 5, 0, 0, 0 }, 0x01, {} },
+  { "Asia/Bishkek", "+06", "", 360, 360, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Chita", "+09", "", 540, 540, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Colombo", "+0530", "", 330, 330, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Famagusta", "EET", "EEST", 120, 180, { 3, 5, 0, 0, 180 }, { 10, 5, 0, 0, 240 }, 0x01, {} },
+  { "Asia/Gaza", "EET", "EEST", 120, 180, { 3, 4, 4, 0, 3000 }, { 10, 4, 4, 0, 3000 }, 0x01, {} },
+  { "Asia/Jerusalem", "IST", "IDT", 120, 180, { 3, 4, 4, 0, 1560 }, { 10, 5, 0, 0, 120 }, 0x01, {} },
+  { "Asia/Kabul", "+0430", "", 270, 270, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Kathmandu", "+0545", "", 345, 345, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Magadan", "+11", "", 660, 660, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Tehran", "+0330", "", 210, 210, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Asia/Yangon", "+0630", "", 390, 390, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Atlantic/Azores", "-01", "+00", -60, 0, { 3, 5, 0, 0, 0 }, { 10, 5, 0, 0, 60 }, 0x01, {} },
+  { "Atlantic/Canary", "WET", "WEST", 0, 60, { 3, 5, 0, 0, 60 }, { 10, 5, 0, 0, 120 }, 0x01, {} },
+  { "Atlantic/Cape_Verde", "-01", "", -60, -60, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Australia/Adelaide", "ACST", "ACDT", 570, 630, { 10, 1, 0, 0, 120 }, { 4, 1, 0, 0, 180 }, 0x01, {} },
+  { "Australia/Darwin", "ACST", "", 570, 570, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Australia/Eucla", "+0845", "", 525, 525, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Australia/Lord_Howe", "+1030", "+11", 630, 660, { 10, 1, 0, 0, 120 }, { 4, 1, 0, 0, 120 }, 0x01, {} },
+  { "Etc/GMT+10", "-10", "", -600, -600, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT+11", "-11", "", -660, -660, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT+12", "-12", "", -720, -720, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT+8", "-08", "", -480, -480, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT+9", "-09", "", -540, -540, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT-13", "+13", "", 780, 780, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Etc/GMT-14", "+14", "", 840, 840, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Europe/Chisinau", "EET", "EEST", 120, 180, { 3, 5, 0, 0, 120 }, { 10, 5, 0, 0, 180 }, 0x01, {} },
+  { "Europe/Dublin", "IST", "GMT", 60, 0, { 10, 5, 0, 0, 120 }, { 3, 5, 0, 0, 60 }, 0x01, {} },
+  { "Pacific/Chatham", "+1245", "+1345", 765, 825, { 9, 5, 0, 0, 165 }, { 4, 1, 0, 0, 225 }, 0x01, {} },
+  { "Pacific/Easter", "-06", "-05", -360, -300, { 9, 1, 6, 0, 1320 }, { 4, 1, 6, 0, 1320 }, 0x01, {} },
+  { "Pacific/Marquesas", "-0930", "", -570, -570, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0 }, 0x00, {} },
+  { "Pacific/Norfolk", "+11", "+12", 660, 720, { 10, 1, 0, 0, 120 }, { 4, 1, 0, 0, 180 }, 0x01, {} },
+};
+
+static const TzVector_t VECTORS[] = {
+  { 0, 1767225600, 0 },
+  { 1, 1767225600, 180 },
+  { 2, 1767225600, 60 },
+  { 3, 1767225600, 120 },
+  { 4, 1767225600, 120 },
+  { 4, 1776981599, 120 },
+  { 4, 1776981600, 180 },
+  { 4, 1793307599, 180 },
+  { 4, 1793307600, 120 },
+  { 4, 1809035999, 120 },
+  { 4, 1809036000, 180 },
+  { 4, 1824757199, 180 },
+  { 4, 1824757200, 120 },
+  { 4, 1840485599, 120 },
+  { 4, 1840485600, 180 },
+  { 4, 1856206799, 180 },
+  { 4, 1856206800, 120 },
+  { 4, 1871935199, 120 },
+  { 4, 1871935200, 180 },
+  { 4, 1887656399, 180 },
+  { 4, 1887656400, 120 },
+  { 4, 1903384799, 120 },
+  { 4, 1903384800, 180 },
+  { 4, 1919710799, 180 },
+  { 4, 1919710800, 120 },
+  { 4, 1934834399, 120 },
+  { 4, 1934834400, 180 },
+  { 4, 1951160399, 180 },
+  { 4, 1951160400, 120 },
+  { 4, 1966888799, 120 },
+  { 4, 1966888800, 180 },
+  { 4, 1982609999, 180 },
+  { 4, 1982610000, 120 },
+  { 4, 1998338399, 120 },
+  { 4, 1998338400, 180 },
+  { 4, 2014059599, 180 },
+  { 4, 2014059600, 120 },
+  { 4, 2029787999, 120 },
+  { 4, 2029788000, 180 },
+  { 4, 2045509199, 180 },
+  { 4, 2045509200, 120 },
+  { 4, 2061237599, 120 },
+  { 4, 2061237600, 180 },
+  { 4, 2076958799, 180 },
+  { 4, 2076958800, 120 },
+  { 5, 1767225600, 60 },
+  { 5, 1774745999, 60 },
+  { 5, 1774746000, 120 },
+  { 5, 1792889999, 120 },
+  { 5, 1792890000, 60 },
+  { 5, 1806195599, 60 },
+  { 5, 1806195600, 120 },
+  { 5, 1824944399, 120 },
+  { 5, 1824944400, 60 },
+  { 5, 1837645199, 60 },
+  { 5, 1837645200, 120 },
+  { 5, 1856393999, 120 },
+  { 5, 1856394000, 60 },
+  { 5, 1869094799, 60 },
+  { 5, 1869094800, 120 },
+  { 5, 1887843599, 120 },
+  { 5, 1887843600, 60 },
+  { 5, 1901149199, 60 },
+  { 5, 1901149200, 120 },
+  { 5, 1919293199, 120 },
+  { 5, 1919293200, 60 },
+  { 5, 1932598799, 60 },
+  { 5, 1932598800, 120 },
+  { 5, 1950742799, 120 },
+  { 5, 1950742800, 60 },
+  { 5, 1964048399, 60 },
+  { 5, 1964048400, 120 },
+  { 5, 1982797199, 120 },
+  { 5, 1982797200, 60 },
+  { 5, 1995497999, 60 },
+  { 5, 1995498000, 120 },
+  { 5, 2014246799, 120 },
+  { 5, 2014246800, 60 },
+  { 5, 2026947599, 60 },
+  { 5, 2026947600, 120 },
+  { 5, 2045696399, 120 },
+  { 5, 2045696400, 60 },
+  { 5, 2058397199, 60 },
+  { 5, 2058397200, 120 },
+  { 5, 2077145999, 120 },
+  { 5, 2077146000, 60 },
+  { 6, 1767225600, -600 },
+  { 6, 1772971199, -600 },
+  { 6, 1772971200, -540 },
+  { 6, 1793530799, -540 },
+  { 6, 1793530800, -600 },
+  { 6, 1805025599, -600 },
+  { 6, 1805025600, -540 },
+  { 6, 1825585199, -540 },
+  { 6, 1825585200, -600 },
+  { 6, 1836475199, -600 },
+  { 6, 1836475200, -540 },
+  { 6, 1857034799, -540 },
+  { 6, 1857034800, -600 },
+  { 6, 1867924799, -600 },
+  { 6, 1867924800, -540 },
+  { 6, 1888484399, -540 },
+  { 6, 1888484400, -600 },
+  { 6, 1899374399, -600 },
+  { 6, 1899374400, -540 },
+  { 6, 1919933999, -540 },
+  { 6, 1919934000, -600 },
+  { 6, 1930823999, -600 },
+  { 6, 1930824000, -540 },
+  { 6, 1951383599, -540 },
+  { 6, 1951383600, -600 },
+  { 6, 1962878399, -600 },
+  { 6, 1962878400, -540 },
+  { 6, 1983437999, -540 },
+  { 6, 1983438000, -600 },
+  { 6, 1994327999, -600 },
+  { 6, 1994328000, -540 },
+  { 6, 2014887599, -540 },
+  { 6, 2014887600, -600 },
+  { 6, 2025777599, -600 },
+  { 6, 2025777600, -540 },
+  { 6, 2046337199, -540 },
+  { 6, 2046337200, -600 },
+  { 6, 2057227199, -600 },
+  { 6, 2057227200, -540 },
+  { 6, 2077786799, -540 },
+  { 6, 2077786800, -600 },
+  { 7, 1767225600, -540 },
+  { 7, 1772967599, -540 },
+  { 7, 1772967600, -480 },
+  { 7, 1793527199, -480 },
+  { 7, 1793527200, -540 },
+  { 7, 1805021999, -540 },
+  { 7, 1805022000, -480 },
+  { 7, 1825581599, -480 },
+  { 7, 1825581600, -540 },
+  { 7, 1836471599, -540 },
+  { 7, 1836471600, -480 },
+  { 7, 1857031199, -480 },
+  { 7, 1857031200, -540 },
+  { 7, 1867921199, -540 },
+  { 7, 1867921200, -480 },
+  { 7, 1888480799, -480 },
+  { 7, 1888480800, -540 },
+  { 7, 1899370799, -540 },
+  { 7, 1899370800, -480 },
+  { 7, 1919930399, -480 },
+  { 7, 1919930400, -540 },
+  { 7, 1930820399, -540 },
+  { 7, 1930820400, -480 },
+  { 7, 1951379999, -480 },
+  { 7, 1951380000, -540 },
+  { 7, 1962874799, -540 },
+  { 7, 1962874800, -480 },
+  { 7, 1983434399, -480 },
+  { 7, 1983434400, -540 },
+  { 7, 1994324399, -540 },
+  { 7, 1994324400, -480 },
+  { 7, 2014883999, -480 },
+  { 7, 2014884000, -540 },
+  { 7, 2025773999, -540 },
+  { 7, 2025774000, -480 },
+  { 7, 2046333599, -480 },
+  { 7, 2046333600, -540 },
+  { 7, 2057223599, -540 },
+  { 7, 2057223600, -480 },
+  { 7, 2077783199, -480 },
+  { 7, 2077783200, -540 },
+  { 8, 1767225600, -240 },
+  { 9, 1767225600, -180 },
+  { 10, 1767225600, -300 },
+  { 11, 1767225600, -360 },
+  { 12, 1767225600, -420 },
+  { 12, 1772960399, -420 },
+  { 12, 1772960400, -360 },
+  { 12, 1793519999, -360 },
+  { 12, 1793520000, -420 },
+  { 12, 1805014799, -420 },
+  { 12, 1805014800, -360 },
+  { 12, 1825574399, -360 },
+  { 12, 1825574400, -420 },
+  { 12, 1836464399, -420 },
+  { 12, 1836464400, -360 },
+  { 12, 1857023999, -360 },
+  { 12, 1857024000, -420 },
+  { 12, 1867913999, -420 },
+  { 12, 1867914000, -360 },
+  { 12, 1888473599, -360 },
+  { 12, 1888473600, -420 },
+  { 12, 1899363599, -420 },
+  { 12, 1899363600, -360 },
+  { 12, 1919923199, -360 },
+  { 12, 1919923200, -420 },
+  { 12, 1930813199, -420 },
+  { 12, 1930813200, -360 },
+  { 12, 1951372799, -360 },
+  { 12, 1951372800, -420 },
+  { 12, 1962867599, -420 },
+  { 12, 1962867600, -360 },
+  { 12, 1983427199, -360 },
+  { 12, 1983427200, -420 },
+  { 12, 1994317199, -420 },
+  { 12, 1994317200, -360 },
+  { 12, 2014876799, -360 },
+  { 12, 2014876800, -420 },
+  { 12, 2025766799, -420 },
+  { 12, 2025766800, -360 },
+  { 12, 2046326399, -360 },
+  { 12, 2046326400, -420 },
+  { 12, 2057216399, -420 },
+  { 12, 2057216400, -360 },
+  { 12, 2077775999, -360 },
+  { 12, 2077776000, -420 },
+  { 13, 1767225600, -360 },
+  { 13, 1772956799, -360 },
+  { 13, 1772956800, -300 },
+  { 13, 1793516399, -300 },
+  { 13, 1793516400, -360 },
+  { 13, 1805011199, -360 },
+  { 13, 1805011200, -300 },
+  { 13, 1825570799, -300 },
+  { 13, 1825570800, -360 },
+  { 13, 1836460799, -360 },
+  { 13, 1836460800, -300 },
+  { 13, 1857020399, -300 },
+  { 13, 1857020400, -360 },
+  { 13, 1867910399, -360 },
+  { 13, 1867910400, -300 },
+  { 13, 1888469999, -300 },
+  { 13, 1888470000, -360 },
+  { 13, 1899359999, -360 },
+  { 13, 1899360000, -300 },
+  { 13, 1919919599, -300 },
+  { 13, 1919919600, -360 },
+  { 13, 1930809599, -360 },
+  { 13, 1930809600, -300 },
+  { 13, 1951369199, -300 },
+  { 13, 1951369200, -360 },
+  { 13, 1962863999, -360 },
+  { 13, 1962864000, -300 },
+  { 13, 1983423599, -300 },
+  { 13, 1983423600, -360 },
+  { 13, 1994313599, -360 },
+  { 13, 1994313600, -300 },
+  { 13, 2014873199, -300 },
+  { 13, 2014873200, -360 },
+  { 13, 2025763199, -360 },
+  { 13, 2025763200, -300 },
+  { 13, 2046322799, -300 },
+  { 13, 2046322800, -360 },
+  { 13, 2057212799, -360 },
+  { 13, 2057212800, -300 },
+  { 13, 2077772399, -300 },
+  { 13, 2077772400, -360 },
+  { 14, 1767225600, -420 },
+  { 15, 1767225600, -300 },
+  { 15, 1772953199, -300 },
+  { 15, 1772953200, -240 },
+  { 15, 1793512799, -240 },
+  { 15, 1793512800, -300 },
+  { 15, 1805007599, -300 },
+  { 15, 1805007600, -240 },
+  { 15, 1825567199, -240 },
+  { 15, 1825567200, -300 },
+  { 15, 1836457199, -300 },
+  { 15, 1836457200, -240 },
+  { 15, 1857016799, -240 },
+  { 15, 1857016800, -300 },
+  { 15, 1867906799, -300 },
+  { 15, 1867906800, -240 },
+  { 15, 1888466399, -240 },
+  { 15, 1888466400, -300 },
+  { 15, 1899356399, -300 },
+  { 15, 1899356400, -240 },
+  { 15, 1919915999, -240 },
+  { 15, 1919916000, -300 },
+  { 15, 1930805999, -300 },
+  { 15, 1930806000, -240 },
+  { 15, 1951365599, -240 },
+  { 15, 1951365600, -300 },
+  { 15, 1962860399, -300 },
+  { 15, 1962860400, -240 },
+  { 15, 1983419999, -240 },
+  { 15, 1983420000, -300 },
+  { 15, 1994309999, -300 },
+  { 15, 1994310000, -240 },
+  { 15, 2014869599, -240 },
+  { 15, 2014869600, -300 },
+  { 15, 2025759599, -300 },
+  { 15, 2025759600, -240 },
+  { 15, 2046319199, -240 },
+  { 15, 2046319200, -300 },
+  { 15, 2057209199, -300 },
+  { 15, 2057209200, -240 },
+  { 15, 2077768799, -240 },
+  { 15, 2077768800, -300 },
+  { 16, 1767225600, -240 },
+  { 16, 1772949599, -240 },
+  { 16, 1772949600, -180 },
+  { 16, 1793509199, -180 },
+  { 16, 1793509200, -240 },
+  { 16, 1805003999, -240 },
+  { 16, 1805004000, -180 },
+  { 16, 1825563599, -180 },
+  { 16, 1825563600, -240 },
+  { 16, 1836453599, -240 },
+  { 16, 1836453600, -180 },
+  { 16, 1857013199, -180 },
+  { 16, 1857013200, -240 },
+  { 16, 1867903199, -240 },
+  { 16, 1867903200, -180 },
+  { 16, 1888462799, -180 },
+  { 16, 1888462800, -240 },
+  { 16, 1899352799, -240 },
+  { 16, 1899352800, -180 },
+  { 16, 1919912399, -180 },
+  { 16, 1919912400, -240 },
+  { 16, 1930802399, -240 },
+  { 16, 1930802400, -180 },
+  { 16, 1951361999, -180 },
+  { 16, 1951362000, -240 },
+  { 16, 1962856799, -240 },
+  { 16, 1962856800, -180 },
+  { 16, 1983416399, -180 },
+  { 16, 1983416400, -240 },
+  { 16, 1994306399, -240 },
+  { 16, 1994306400, -180 },
+  { 16, 2014865999, -180 },
+  { 16, 2014866000, -240 },
+  { 16, 2025755999, -240 },
+  { 16, 2025756000, -180 },
+  { 16, 2046315599, -180 },
+  { 16, 2046315600, -240 },
+  { 16, 2057205599, -240 },
+  { 16, 2057205600, -180 },
+  { 16, 2077765199, -180 },
+  { 16, 2077765200, -240 },
+  { 17, 1767225600, -300 },
+  { 17, 1772945999, -300 },
+  { 17, 1772946000, -240 },
+  { 17, 1793509199, -240 },
+  { 17, 1793509200, -300 },
+  { 17, 1805000399, -300 },
+  { 17, 1805000400, -240 },
+  { 17, 1825563599, -240 },
+  { 17, 1825563600, -300 },
+  { 17, 1836449999, -300 },
+  { 17, 1836450000, -240 },
+  { 17, 1857013199, -240 },
+  { 17, 1857013200, -300 },
+  { 17, 1867899599, -300 },
+  { 17, 1867899600, -240 },
+  { 17, 1888462799, -240 },
+  { 17, 1888462800, -300 },
+  { 17, 1899349199, -300 },
+  { 17, 1899349200, -240 },
+  { 17, 1919912399, -240 },
+  { 17, 1919912400, -300 },
+  { 17, 1930798799, -300 },
+  { 17, 1930798800, -240 },
+  { 17, 1951361999, -240 },
+  { 17, 1951362000, -300 },
+  { 17, 1962853199, -300 },
+  { 17, 1962853200, -240 },
+  { 17, 1983416399, -240 },
+  { 17, 1983416400, -300 },
+  { 17, 1994302799, -300 },
+  { 17, 1994302800, -240 },
+  { 17, 2014865999, -240 },
+  { 17, 2014866000, -300 },
+  { 17, 2025752399, -300 },
+  { 17, 2025752400, -240 },
+  { 17, 2046315599, -240 },
+  { 17, 2046315600, -300 },
+  { 17, 2057201999, -300 },
+  { 17, 2057202000, -240 },
+  { 17, 2077765199, -240 },
+  { 17, 2077765200, -300 },
+  { 18, 1767225600, -480 },
+  { 18, 1772963999, -480 },
+  { 18, 1772964000, -420 },
+  { 18, 1793523599, -420 },
+  { 18, 1793523600, -480 },
+  { 18, 1805018399, -480 },
+  { 18, 1805018400, -420 },
+  { 18, 1825577999, -420 },
+  { 18, 1825578000, -480 },
+  { 18, 1836467999, -480 },
+  { 18, 1836468000, -420 },
+  { 18, 1857027599, -420 },
+  { 18, 1857027600, -480 },
+  { 18, 1867917599, -480 },
+  { 18, 1867917600, -420 },
+  { 18, 1888477199, -420 },
+  { 18, 1888477200, -480 },
+  { 18, 1899367199, -480 },
+  { 18, 1899367200, -420 },
+  { 18, 1919926799, -420 },
+  { 18, 1919926800, -480 },
+  { 18, 1930816799, -480 },
+  { 18, 1930816800, -420 },
+  { 18, 1951376399, -420 },
+  { 18, 1951376400, -480 },
+  { 18, 1962871199, -480 },
+  { 18, 1962871200, -420 },
+  { 18, 1983430799, -420 },
+  { 18, 1983430800, -480 },
+  { 18, 1994320799, -480 },
+  { 18, 1994320800, -420 },
+  { 18, 2014880399, -420 },
+  { 18, 2014880400, -480 },
+  { 18, 2025770399, -480 },
+  { 18, 2025770400, -420 },
+  { 18, 2046329999, -420 },
+  { 18, 2046330000, -480 },
+  { 18, 2057219999, -480 },
+  { 18, 2057220000, -420 },
+  { 18, 2077779599, -420 },
+  { 18, 2077779600, -480 },
+  { 19, 1767225600, -180 },
+  { 19, 1772945999, -180 },
+  { 19, 1772946000, -120 },
+  { 19, 1793505599, -120 },
+  { 19, 1793505600, -180 },
+  { 19, 1805000399, -180 },
+  { 19, 1805000400, -120 },
+  { 19, 1825559999, -120 },
+  { 19, 1825560000, -180 },
+  { 19, 1836449999, -180 },
+  { 19, 1836450000, -120 },
+  { 19, 1857009599, -120 },
+  { 19, 1857009600, -180 },
+  { 19, 1867899599, -180 },
+  { 19, 1867899600, -120 },
+  { 19, 1888459199, -120 },
+  { 19, 1888459200, -180 },
+  { 19, 1899349199, -180 },
+  { 19, 1899349200, -120 },
+  { 19, 1919908799, -120 },
+  { 19, 1919908800, -180 },
+  { 19, 1930798799, -180 },
+  { 19, 1930798800, -120 },
+  { 19, 1951358399, -120 },
+  { 19, 1951358400, -180 },
+  { 19, 1962853199, -180 },
+  { 19, 1962853200, -120 },
+  { 19, 1983412799, -120 },
+  { 19, 1983412800, -180 },
+  { 19, 1994302799, -180 },
+  { 19, 1994302800, -120 },
+  { 19, 2014862399, -120 },
+  { 19, 2014862400, -180 },
+  { 19, 2025752399, -180 },
+  { 19, 2025752400, -120 },
+  { 19, 2046311999, -120 },
+  { 19, 2046312000, -180 },
+  { 19, 2057201999, -180 },
+  { 19, 2057202000, -120 },
+  { 19, 2077761599, -120 },
+  { 19, 2077761600, -180 },
+  { 20, 1767225600, -120 },
+  { 21, 1767225600, -120 },
+  { 21, 1774745999, -120 },
+  { 21, 1774746000, -60 },
+  { 21, 1792889999, -60 },
+  { 21, 1792890000, -120 },
+  { 21, 1806195599, -120 },
+  { 21, 1806195600, -60 },
+  { 21, 1824944399, -60 },
+  { 21, 1824944400, -120 },
+  { 21, 1837645199, -120 },
+  { 21, 1837645200, -60 },
+  { 21, 1856393999, -60 },
+  { 21, 1856394000, -120 },
+  { 21, 1869094799, -120 },
+  { 21, 1869094800, -60 },
+  { 21, 1887843599, -60 },
+  { 21, 1887843600, -120 },
+  { 21, 1901149199, -120 },
+  { 21, 1901149200, -60 },
+  { 21, 1919293199, -60 },
+  { 21, 1919293200, -120 },
+  { 21, 1932598799, -120 },
+  { 21, 1932598800, -60 },
+  { 21, 1950742799, -60 },
+  { 21, 1950742800, -120 },
+  { 21, 1964048399, -120 },
+  { 21, 1964048400, -60 },
+  { 21, 1982797199, -60 },
+  { 21, 1982797200, -120 },
+  { 21, 1995497999, -120 },
+  { 21, 1995498000, -60 },
+  { 21, 2014246799, -60 },
+  { 21, 2014246800, -120 },
+  { 21, 2026947599, -120 },
+  { 21, 2026947600, -60 },
+  { 21, 2045696399, -60 },
+  { 21, 2045696400, -120 },
+  { 21, 2058397199, -120 },
+  { 21, 2058397200, -60 },
+  { 21, 2077145999, -60 },
+  { 21, 2077146000, -120 },
+  { 22, 1767225600, -180 },
+  { 22, 1775357999, -180 },
+  { 22, 1775358000, -240 },
+  { 22, 1788667199, -240 },
+  { 22, 1788667200, -180 },
+  { 22, 1806807599, -180 },
+  { 22, 1806807600, -240 },
+  { 22, 1820116799, -240 },
+  { 22, 1820116800, -180 },
+  { 22, 1838257199, -180 },
+  { 22, 1838257200, -240 },
+  { 22, 1851566399, -240 },
+  { 22, 1851566400, -180 },
+  { 22, 1870311599, -180 },
+  { 22, 1870311600, -240 },
+  { 22, 1883015999, -240 },
+  { 22, 1883016000, -180 },
+  { 22, 1901761199, -180 },
+  { 22, 1901761200, -240 },
+  { 22, 1915070399, -240 },
+  { 22, 1915070400, -180 },
+  { 22, 1933210799, -180 },
+  { 22, 1933210800, -240 },
+  { 22, 1946519999, -240 },
+  { 22, 1946520000, -180 },
+  { 22, 1964660399, -180 },
+  { 22, 1964660400, -240 },
+  { 22, 1977969599, -240 },
+  { 22, 1977969600, -180 },
+  { 22, 1996109999, -180 },
+  { 22, 1996110000, -240 },
+  { 22, 2009419199, -240 },
+  { 22, 2009419200, -180 },
+  { 22, 2027559599, -180 },
+  { 22, 2027559600, -240 },
+  { 22, 2040868799, -240 },
+  { 22, 2040868800, -180 },
+  { 22, 2059613999, -180 },
+  { 22, 2059614000, -240 },
+  { 22, 2072318399, -240 },
+  { 22, 2072318400, -180 },
+  { 23, 1767225600, -210 },
+  { 23, 1772947799, -210 },
+  { 23, 1772947800, -150 },
+  { 23, 1793507399, -150 },
+  { 23, 1793507400, -210 },
+  { 23, 1805002199, -210 },
+  { 23, 1805002200, -150 },
+  { 23, 1825561799, -150 },
+  { 23, 1825561800, -210 },
+  { 23, 1836451799, -210 },
+  { 23, 1836451800, -150 },
+  { 23, 1857011399, -150 },
+  { 23, 1857011400, -210 },
+  { 23, 1867901399, -210 },
+  { 23, 1867901400, -150 },
+  { 23, 1888460999, -150 },
+  { 23, 1888461000, -210 },
+  { 23, 1899350999, -210 },
+  { 23, 1899351000, -150 },
+  { 23, 1919910599, -150 },
+  { 23, 1919910600, -210 },
+  { 23, 1930800599, -210 },
+  { 23, 1930800600, -150 },
+  { 23, 1951360199, -150 },
+  { 23, 1951360200, -210 },
+  { 23, 1962854999, -210 },
+  { 23, 1962855000, -150 },
+  { 23, 1983414599, -150 },
+  { 23, 1983414600, -210 },
+  { 23, 1994304599, -210 },
+  { 23, 1994304600, -150 },
+  { 23, 2014864199, -150 },
+  { 23, 2014864200, -210 },
+  { 23, 2025754199, -210 },
+  { 23, 2025754200, -150 },
+  { 23, 2046313799, -150 },
+  { 23, 2046313800, -210 },
+  { 23, 2057203799, -210 },
+  { 23, 2057203800, -150 },
+  { 23, 2077763399, -150 },
+  { 23, 2077763400, -210 },
+  { 24, 1767225600, 480 },
+  { 25, 1767225600, 420 },
+  { 26, 1767225600, 600 },
+  { 27, 1767225600, 660 },
+  { 27, 1775318399, 660 },
+  { 27, 1775318400, 600 },
+  { 27, 1791043199, 600 },
+  { 27, 1791043200, 660 },
+  { 27, 1806767999, 660 },
+  { 27, 1806768000, 600 },
+  { 27, 1822492799, 600 },
+  { 27, 1822492800, 660 },
+  { 27, 1838217599, 660 },
+  { 27, 1838217600, 600 },
+  { 27, 1853942399, 600 },
+  { 27, 1853942400, 660 },
+  { 27, 1869667199, 660 },
+  { 27, 1869667200, 600 },
+  { 27, 1885996799, 600 },
+  { 27, 1885996800, 660 },
+  { 27, 1901721599, 660 },
+  { 27, 1901721600, 600 },
+  { 27, 1917446399, 600 },
+  { 27, 1917446400, 660 },
+  { 27, 1933171199, 660 },
+  { 27, 1933171200, 600 },
+  { 27, 1948895999, 600 },
+  { 27, 1948896000, 660 },
+  { 27, 1964620799, 660 },
+  { 27, 1964620800, 600 },
+  { 27, 1980345599, 600 },
+  { 27, 1980345600, 660 },
+  { 27, 1996070399, 660 },
+  { 27, 1996070400, 600 },
+  { 27, 2011795199, 600 },
+  { 27, 2011795200, 660 },
+  { 27, 2027519999, 660 },
+  { 27, 2027520000, 600 },
+  { 27, 2043244799, 600 },
+  { 27, 2043244800, 660 },
+  { 27, 2058969599, 660 },
+  { 27, 2058969600, 600 },
+  { 27, 2075299199, 600 },
+  { 27, 2075299200, 660 },
+  { 28, 1767225600, 300 },
+  { 29, 1767225600, 780 },
+  { 29, 1775311199, 780 },
+  { 29, 1775311200, 720 },
+  { 29, 1790431199, 720 },
+  { 29, 1790431200, 780 },
+  { 29, 1806760799, 780 },
+  { 29, 1806760800, 720 },
+  { 29, 1821880799, 720 },
+  { 29, 1821880800, 780 },
+  { 29, 1838210399, 780 },
+  { 29, 1838210400, 720 },
+  { 29, 1853330399, 720 },
+  { 29, 1853330400, 780 },
+  { 29, 1869659999, 780 },
+  { 29, 1869660000, 720 },
+  { 29, 1885384799, 720 },
+  { 29, 1885384800, 780 },
+  { 29, 1901714399, 780 },
+  { 29, 1901714400, 720 },
+  { 29, 1916834399, 720 },
+  { 29, 1916834400, 780 },
+  { 29, 1933163999, 780 },
+  { 29, 1933164000, 720 },
+  { 29, 1948283999, 720 },
+  { 29, 1948284000, 780 },
+  { 29, 1964613599, 780 },
+  { 29, 1964613600, 720 },
+  { 29, 1979733599, 720 },
+  { 29, 1979733600, 780 },
+  { 29, 1996063199, 780 },
+  { 29, 1996063200, 720 },
+  { 29, 2011183199, 720 },
+  { 29, 2011183200, 780 },
+  { 29, 2027512799, 780 },
+  { 29, 2027512800, 720 },
+  { 29, 2042632799, 720 },
+  { 29, 2042632800, 780 },
+  { 29, 2058962399, 780 },
+  { 29, 2058962400, 720 },
+  { 29, 2074687199, 720 },
+  { 29, 2074687200, 780 },
+  { 30, 1767225600, 0 },
+  { 30, 1774745999, 0 },
+  { 30, 1774746000, 120 },
+  { 30, 1792889999, 120 },
+  { 30, 1792890000, 0 },
+  { 30, 1806195599, 0 },
+  { 30, 1806195600, 120 },
+  { 30, 1824944399, 120 },
+  { 30, 1824944400, 0 },
+  { 30, 1837645199, 0 },
+  { 30, 1837645200, 120 },
+  { 30, 1856393999, 120 },
+  { 30, 1856394000, 0 },
+  { 30, 1869094799, 0 },
+  { 30, 1869094800, 120 },
+  { 30, 1887843599, 120 },
+  { 30, 1887843600, 0 },
+  { 30, 1901149199, 0 },
+  { 30, 1901149200, 120 },
+  { 30, 1919293199, 120 },
+  { 30, 1919293200, 0 },
+  { 30, 1932598799, 0 },
+  { 30, 1932598800, 120 },
+  { 30, 1950742799, 120 },
+  { 30, 1950742800, 0 },
+  { 30, 1964048399, 0 },
+  { 30, 1964048400, 120 },
+  { 30, 1982797199, 120 },
+  { 30, 1982797200, 0 },
+  { 30, 1995497999, 0 },
+  { 30, 1995498000, 120 },
+  { 30, 2014246799, 120 },
+  { 30, 2014246800, 0 },
+  { 30, 2026947599, 0 },
+  { 30, 2026947600, 120 },
+  { 30, 2045696399, 120 },
+  { 30, 2045696400, 0 },
+  { 30, 2058397199, 0 },
+  { 30, 2058397200, 120 },
+  { 30, 2077145999, 120 },
+  { 30, 2077146000, 0 },
+  { 31, 1767225600, 720 },
+  { 32, 1767225600, 240 },
+  { 33, 1767225600, 120 },
+  { 33, 1774735199, 120 },
+  { 33, 1774735200, 180 },
+  { 33, 1792875599, 180 },
+  { 33, 1792875600, 120 },
+  { 33, 1806184799, 120 },
+  { 33, 1806184800, 180 },
+  { 33, 1824929999, 180 },
+  { 33, 1824930000, 120 },
+  { 33, 1837634399, 120 },
+  { 33, 1837634400, 180 },
+  { 33, 1856379599, 180 },
+  { 33, 1856379600, 120 },
+  { 33, 1869083999, 120 },
+  { 33, 1869084000, 180 },
+  { 33, 1887829199, 180 },
+  { 33, 1887829200, 120 },
+  { 33, 1901138399, 120 },
+  { 33, 1901138400, 180 },
+  { 33, 1919278799, 180 },
+  { 33, 1919278800, 120 },
+  { 33, 1932587999, 120 },
+  { 33, 1932588000, 180 },
+  { 33, 1950728399, 180 },
+  { 33, 1950728400, 120 },
+  { 33, 1964037599, 120 },
+  { 33, 1964037600, 180 },
+  { 33, 1982782799, 180 },
+  { 33, 1982782800, 120 },
+  { 33, 1995487199, 120 },
+  { 33, 1995487200, 180 },
+  { 33, 2014232399, 180 },
+  { 33, 2014232400, 120 },
+  { 33, 2026936799, 120 },
+  { 33, 2026936800, 180 },
+  { 33, 2045681999, 180 },
+  { 33, 2045682000, 120 },
+  { 33, 2058386399, 120 },
+  { 33, 2058386400, 180 },
+  { 33, 2077131599, 180 },
+  { 33, 2077131600, 120 },
+  { 34, 1767225600, 360 },
+  { 35, 1767225600, 540 },
+  { 36, 1767225600, 330 },
+  { 37, 1767225600, 120 },
+  { 37, 1774745999, 120 },
+  { 37, 1774746000, 180 },
+  { 37, 1792889999, 180 },
+  { 37, 1792890000, 120 },
+  { 37, 1806195599, 120 },
+  { 37, 1806195600, 180 },
+  { 37, 1824944399, 180 },
+  { 37, 1824944400, 120 },
+  { 37, 1837645199, 120 },
+  { 37, 1837645200, 180 },
+  { 37, 1856393999, 180 },
+  { 37, 1856394000, 120 },
+  { 37, 1869094799, 120 },
+  { 37, 1869094800, 180 },
+  { 37, 1887843599, 180 },
+  { 37, 1887843600, 120 },
+  { 37, 1901149199, 120 },
+  { 37, 1901149200, 180 },
+  { 37, 1919293199, 180 },
+  { 37, 1919293200, 120 },
+  { 37, 1932598799, 120 },
+  { 37, 1932598800, 180 },
+  { 37, 1950742799, 180 },
+  { 37, 1950742800, 120 },
+  { 37, 1964048399, 120 },
+  { 37, 1964048400, 180 },
+  { 37, 1982797199, 180 },
+  { 37, 1982797200, 120 },
+  { 37, 1995497999, 120 },
+  { 37, 1995498000, 180 },
+  { 37, 2014246799, 180 },
+  { 37, 2014246800, 120 },
+  { 37, 2026947599, 120 },
+  { 37, 2026947600, 180 },
+  { 37, 2045696399, 180 },
+  { 37, 2045696400, 120 },
+  { 37, 2058397199, 120 },
+  { 37, 2058397200, 180 },
+  { 37, 2077145999, 180 },
+  { 37, 2077146000, 120 },
+  { 38, 1767225600, 120 },
+  { 38, 1774655999, 120 },
+  { 38, 1774656000, 180 },
+  { 38, 1792796399, 180 },
+  { 38, 1792796400, 120 },
+  { 38, 1806105599, 120 },
+  { 38, 1806105600, 180 },
+  { 38, 1824850799, 180 },
+  { 38, 1824850800, 120 },
+  { 38, 1837555199, 120 },
+  { 38, 1837555200, 180 },
+  { 38, 1856300399, 180 },
+  { 38, 1856300400, 120 },
+  { 38, 1869004799, 120 },
+  { 38, 1869004800, 180 },
+  { 38, 1887749999, 180 },
+  { 38, 1887750000, 120 },
+  { 38, 1901059199, 120 },
+  { 38, 1901059200, 180 },
+  { 38, 1919199599, 180 },
+  { 38, 1919199600, 120 },
+  { 38, 1932508799, 120 },
+  { 38, 1932508800, 180 },
+  { 38, 1950649199, 180 },
+  { 38, 1950649200, 120 },
+  { 38, 1963958399, 120 },
+  { 38, 1963958400, 180 },
+  { 38, 1982703599, 180 },
+  { 38, 1982703600, 120 },
+  { 38, 1995407999, 120 },
+  { 38, 1995408000, 180 },
+  { 38, 2014153199, 180 },
+  { 38, 2014153200, 120 },
+  { 38, 2026857599, 120 },
+  { 38, 2026857600, 180 },
+  { 38, 2045602799, 180 },
+  { 38, 2045602800, 120 },
+  { 38, 2058307199, 120 },
+  { 38, 2058307200, 180 },
+  { 38, 2077052399, 180 },
+  { 38, 2077052400, 120 },
+  { 39, 1767225600, 120 },
+  { 39, 1774569599, 120 },
+  { 39, 1774569600, 180 },
+  { 39, 1792882799, 180 },
+  { 39, 1792882800, 120 },
+  { 39, 1806019199, 120 },
+  { 39, 1806019200, 180 },
+  { 39, 1824937199, 180 },
+  { 39, 1824937200, 120 },
+  { 39, 1837468799, 120 },
+  { 39, 1837468800, 180 },
+  { 39, 1856386799, 180 },
+  { 39, 1856386800, 120 },
+  { 39, 1868918399, 120 },
+  { 39, 1868918400, 180 },
+  { 39, 1887836399, 180 },
+  { 39, 1887836400, 120 },
+  { 39, 1900972799, 120 },
+  { 39, 1900972800, 180 },
+  { 39, 1919285999, 180 },
+  { 39, 1919286000, 120 },
+  { 39, 1932422399, 120 },
+  { 39, 1932422400, 180 },
+  { 39, 1950735599, 180 },
+  { 39, 1950735600, 120 },
+  { 39, 1963871999, 120 },
+  { 39, 1963872000, 180 },
+  { 39, 1982789999, 180 },
+  { 39, 1982790000, 120 },
+  { 39, 1995321599, 120 },
+  { 39, 1995321600, 180 },
+  { 39, 2014239599, 180 },
+  { 39, 2014239600, 120 },
+  { 39, 2026771199, 120 },
+  { 39, 2026771200, 180 },
+  { 39, 2045689199, 180 },
+  { 39, 2045689200, 120 },
+  { 39, 2058220799, 120 },
+  { 39, 2058220800, 180 },
+  { 39, 2077138799, 180 },
+  { 39, 2077138800, 120 },
+  { 40, 1767225600, 270 },
+  { 41, 1767225600, 345 },
+  { 42, 1767225600, 660 },
+  { 43, 1767225600, 210 },
+  { 44, 1767225600, 390 },
+  { 45, 1767225600, -60 },
+  { 45, 1774745999, -60 },
+  { 45, 1774746000, 0 },
+  { 45, 1792889999, 0 },
+  { 45, 1792890000, -60 },
+  { 45, 1806195599, -60 },
+  { 45, 1806195600, 0 },
+  { 45, 1824944399, 0 },
+  { 45, 1824944400, -60 },
+  { 45, 1837645199, -60 },
+  { 45, 1837645200, 0 },
+  { 45, 1856393999, 0 },
+  { 45, 1856394000, -60 },
+  { 45, 1869094799, -60 },
+  { 45, 1869094800, 0 },
+  { 45, 1887843599, 0 },
+  { 45, 1887843600, -60 },
+  { 45, 1901149199, -60 },
+  { 45, 1901149200, 0 },
+  { 45, 1919293199, 0 },
+  { 45, 1919293200, -60 },
+  { 45, 1932598799, -60 },
+  { 45, 1932598800, 0 },
+  { 45, 1950742799, 0 },
+  { 45, 1950742800, -60 },
+  { 45, 1964048399, -60 },
+  { 45, 1964048400, 0 },
+  { 45, 1982797199, 0 },
+  { 45, 1982797200, -60 },
+  { 45, 1995497999, -60 },
+  { 45, 1995498000, 0 },
+  { 45, 2014246799, 0 },
+  { 45, 2014246800, -60 },
+  { 45, 2026947599, -60 },
+  { 45, 2026947600, 0 },
+  { 45, 2045696399, 0 },
+  { 45, 2045696400, -60 },
+  { 45, 2058397199, -60 },
+  { 45, 2058397200, 0 },
+  { 45, 2077145999, 0 },
+  { 45, 2077146000, -60 },
+  { 46, 1767225600, 0 },
+  { 46, 1774745999, 0 },
+  { 46, 1774746000, 60 },
+  { 46, 1792889999, 60 },
+  { 46, 1792890000, 0 },
+  { 46, 1806195599, 0 },
+  { 46, 1806195600, 60 },
+  { 46, 1824944399, 60 },
+  { 46, 1824944400, 0 },
+  { 46, 1837645199, 0 },
+  { 46, 1837645200, 60 },
+  { 46, 1856393999, 60 },
+  { 46, 1856394000, 0 },
+  { 46, 1869094799, 0 },
+  { 46, 1869094800, 60 },
+  { 46, 1887843599, 60 },
+  { 46, 1887843600, 0 },
+  { 46, 1901149199, 0 },
+  { 46, 1901149200, 60 },
+  { 46, 1919293199, 60 },
+  { 46, 1919293200, 0 },
+  { 46, 1932598799, 0 },
+  { 46, 1932598800, 60 },
+  { 46, 1950742799, 60 },
+  { 46, 1950742800, 0 },
+  { 46, 1964048399, 0 },
+  { 46, 1964048400, 60 },
+  { 46, 1982797199, 60 },
+  { 46, 1982797200, 0 },
+  { 46, 1995497999, 0 },
+  { 46, 1995498000, 60 },
+  { 46, 2014246799, 60 },
+  { 46, 2014246800, 0 },
+  { 46, 2026947599, 0 },
+  { 46, 2026947600, 60 },
+  { 46, 2045696399, 60 },
+  { 46, 2045696400, 0 },
+  { 46, 2058397199, 0 },
+  { 46, 2058397200, 60 },
+  { 46, 2077145999, 60 },
+  { 46, 2077146000, 0 },
+  { 47, 1767225600, -60 },
+  { 48, 1767225600, 630 },
+  { 48, 1775320199, 630 },
+  { 48, 1775320200, 570 },
+  { 48, 1791044999, 570 },
+  { 48, 1791045000, 630 },
+  { 48, 1806769799, 630 },
+  { 48, 1806769800, 570 },
+  { 48, 1822494599, 570 },
+  { 48, 1822494600, 630 },
+  { 48, 1838219399, 630 },
+  { 48, 1838219400, 570 },
+  { 48, 1853944199, 570 },
+  { 48, 1853944200, 630 },
+  { 48, 1869668999, 630 },
+  { 48, 1869669000, 570 },
+  { 48, 1885998599, 570 },
+  { 48, 1885998600, 630 },
+  { 48, 1901723399, 630 },
+  { 48, 1901723400, 570 },
+  { 48, 1917448199, 570 },
+  { 48, 1917448200, 630 },
+  { 48, 1933172999, 630 },
+  { 48, 1933173000, 570 },
+  { 48, 1948897799, 570 },
+  { 48, 1948897800, 630 },
+  { 48, 1964622599, 630 },
+  { 48, 1964622600, 570 },
+  { 48, 1980347399, 570 },
+  { 48, 1980347400, 630 },
+  { 48, 1996072199, 630 },
+  { 48, 1996072200, 570 },
+  { 48, 2011796999, 570 },
+  { 48, 2011797000, 630 },
+  { 48, 2027521799, 630 },
+  { 48, 2027521800, 570 },
+  { 48, 2043246599, 570 },
+  { 48, 2043246600, 630 },
+  { 48, 2058971399, 630 },
+  { 48, 2058971400, 570 },
+  { 48, 2075300999, 570 },
+  { 48, 2075301000, 630 },
+  { 49, 1767225600, 570 },
+  { 50, 1767225600, 525 },
+  { 51, 1767225600, 660 },
+  { 51, 1775314799, 660 },
+  { 51, 1775314800, 630 },
+  { 51, 1791041399, 630 },
+  { 51, 1791041400, 660 },
+  { 51, 1806764399, 660 },
+  { 51, 1806764400, 630 },
+  { 51, 1822490999, 630 },
+  { 51, 1822491000, 660 },
+  { 51, 1838213999, 660 },
+  { 51, 1838214000, 630 },
+  { 51, 1853940599, 630 },
+  { 51, 1853940600, 660 },
+  { 51, 1869663599, 660 },
+  { 51, 1869663600, 630 },
+  { 51, 1885994999, 630 },
+  { 51, 1885995000, 660 },
+  { 51, 1901717999, 660 },
+  { 51, 1901718000, 630 },
+  { 51, 1917444599, 630 },
+  { 51, 1917444600, 660 },
+  { 51, 1933167599, 660 },
+  { 51, 1933167600, 630 },
+  { 51, 1948894199, 630 },
+  { 51, 1948894200, 660 },
+  { 51, 1964617199, 660 },
+  { 51, 1964617200, 630 },
+  { 51, 1980343799, 630 },
+  { 51, 1980343800, 660 },
+  { 51, 1996066799, 660 },
+  { 51, 1996066800, 630 },
+  { 51, 2011793399, 630 },
+  { 51, 2011793400, 660 },
+  { 51, 2027516399, 660 },
+  { 51, 2027516400, 630 },
+  { 51, 2043242999, 630 },
+  { 51, 2043243000, 660 },
+  { 51, 2058965999, 660 },
+  { 51, 2058966000, 630 },
+  { 51, 2075297399, 630 },
+  { 51, 2075297400, 660 },
+  { 52, 1767225600, -600 },
+  { 53, 1767225600, -660 },
+  { 54, 1767225600, -720 },
+  { 55, 1767225600, -480 },
+  { 56, 1767225600, -540 },
+  { 57, 1767225600, 780 },
+  { 58, 1767225600, 840 },
+  { 59, 1767225600, 120 },
+  { 59, 1774742399, 120 },
+  { 59, 1774742400, 180 },
+  { 59, 1792886399, 180 },
+  { 59, 1792886400, 120 },
+  { 59, 1806191999, 120 },
+  { 59, 1806192000, 180 },
+  { 59, 1824940799, 180 },
+  { 59, 1824940800, 120 },
+  { 59, 1837641599, 120 },
+  { 59, 1837641600, 180 },
+  { 59, 1856390399, 180 },
+  { 59, 1856390400, 120 },
+  { 59, 1869091199, 120 },
+  { 59, 1869091200, 180 },
+  { 59, 1887839999, 180 },
+  { 59, 1887840000, 120 },
+  { 59, 1901145599, 120 },
+  { 59, 1901145600, 180 },
+  { 59, 1919289599, 180 },
+  { 59, 1919289600, 120 },
+  { 59, 1932595199, 120 },
+  { 59, 1932595200, 180 },
+  { 59, 1950739199, 180 },
+  { 59, 1950739200, 120 },
+  { 59, 1964044799, 120 },
+  { 59, 1964044800, 180 },
+  { 59, 1982793599, 180 },
+  { 59, 1982793600, 120 },
+  { 59, 1995494399, 120 },
+  { 59, 1995494400, 180 },
+  { 59, 2014243199, 180 },
+  { 59, 2014243200, 120 },
+  { 59, 2026943999, 120 },
+  { 59, 2026944000, 180 },
+  { 59, 2045692799, 180 },
+  { 59, 2045692800, 120 },
+  { 59, 2058393599, 120 },
+  { 59, 2058393600, 180 },
+  { 59, 2077142399, 180 },
+  { 59, 2077142400, 120 },
+  { 60, 1767225600, 0 },
+  { 60, 1774745999, 0 },
+  { 60, 1774746000, 60 },
+  { 60, 1792889999, 60 },
+  { 60, 1792890000, 0 },
+  { 60, 1806195599, 0 },
+  { 60, 1806195600, 60 },
+  { 60, 1824944399, 60 },
+  { 60, 1824944400, 0 },
+  { 60, 1837645199, 0 },
+  { 60, 1837645200, 60 },
+  { 60, 1856393999, 60 },
+  { 60, 1856394000, 0 },
+  { 60, 1869094799, 0 },
+  { 60, 1869094800, 60 },
+  { 60, 1887843599, 60 },
+  { 60, 1887843600, 0 },
+  { 60, 1901149199, 0 },
+  { 60, 1901149200, 60 },
+  { 60, 1919293199, 60 },
+  { 60, 1919293200, 0 },
+  { 60, 1932598799, 0 },
+  { 60, 1932598800, 60 },
+  { 60, 1950742799, 60 },
+  { 60, 1950742800, 0 },
+  { 60, 1964048399, 0 },
+  { 60, 1964048400, 60 },
+  { 60, 1982797199, 60 },
+  { 60, 1982797200, 0 },
+  { 60, 1995497999, 0 },
+  { 60, 1995498000, 60 },
+  { 60, 2014246799, 60 },
+  { 60, 2014246800, 0 },
+  { 60, 2026947599, 0 },
+  { 60, 2026947600, 60 },
+  { 60, 2045696399, 60 },
+  { 60, 2045696400, 0 },
+  { 60, 2058397199, 0 },
+  { 60, 2058397200, 60 },
+  { 60, 2077145999, 60 },
+  { 60, 2077146000, 0 },
+  { 61, 1767225600, 825 },
+  { 61, 1775311199, 825 },
+  { 61, 1775311200, 765 },
+  { 61, 1790431199, 765 },
+  { 61, 1790431200, 825 },
+  { 61, 1806760799, 825 },
+  { 61, 1806760800, 765 },
+  { 61, 1821880799, 765 },
+  { 61, 1821880800, 825 },
+  { 61, 1838210399, 825 },
+  { 61, 1838210400, 765 },
+  { 61, 1853330399, 765 },
+  { 61, 1853330400, 825 },
+  { 61, 1869659999, 825 },
+  { 61, 1869660000, 765 },
+  { 61, 1885384799, 765 },
+  { 61, 1885384800, 825 },
+  { 61, 1901714399, 825 },
+  { 61, 1901714400, 765 },
+  { 61, 1916834399, 765 },
+  { 61, 1916834400, 825 },
+  { 61, 1933163999, 825 },
+  { 61, 1933164000, 765 },
+  { 61, 1948283999, 765 },
+  { 61, 1948284000, 825 },
+  { 61, 1964613599, 825 },
+  { 61, 1964613600, 765 },
+  { 61, 1979733599, 765 },
+  { 61, 1979733600, 825 },
+  { 61, 1996063199, 825 },
+  { 61, 1996063200, 765 },
+  { 61, 2011183199, 765 },
+  { 61, 2011183200, 825 },
+  { 61, 2027512799, 825 },
+  { 61, 2027512800, 765 },
+  { 61, 2042632799, 765 },
+  { 61, 2042632800, 825 },
+  { 61, 2058962399, 825 },
+  { 61, 2058962400, 765 },
+  { 61, 2074687199, 765 },
+  { 61, 2074687200, 825 },
+  { 62, 1767225600, -300 },
+  { 62, 1775357999, -300 },
+  { 62, 1775358000, -360 },
+  { 62, 1788667199, -360 },
+  { 62, 1788667200, -300 },
+  { 62, 1806807599, -300 },
+  { 62, 1806807600, -360 },
+  { 62, 1820116799, -360 },
+  { 62, 1820116800, -300 },
+  { 62, 1838257199, -300 },
+  { 62, 1838257200, -360 },
+  { 62, 1851566399, -360 },
+  { 62, 1851566400, -300 },
+  { 62, 1870311599, -300 },
+  { 62, 1870311600, -360 },
+  { 62, 1883015999, -360 },
+  { 62, 1883016000, -300 },
+  { 62, 1901761199, -300 },
+  { 62, 1901761200, -360 },
+  { 62, 1915070399, -360 },
+  { 62, 1915070400, -300 },
+  { 62, 1933210799, -300 },
+  { 62, 1933210800, -360 },
+  { 62, 1946519999, -360 },
+  { 62, 1946520000, -300 },
+  { 62, 1964660399, -300 },
+  { 62, 1964660400, -360 },
+  { 62, 1977969599, -360 },
+  { 62, 1977969600, -300 },
+  { 62, 1996109999, -300 },
+  { 62, 1996110000, -360 },
+  { 62, 2009419199, -360 },
+  { 62, 2009419200, -300 },
+  { 62, 2027559599, -300 },
+  { 62, 2027559600, -360 },
+  { 62, 2040868799, -360 },
+  { 62, 2040868800, -300 },
+  { 62, 2059613999, -300 },
+  { 62, 2059614000, -360 },
+  { 62, 2072318399, -360 },
+  { 62, 2072318400, -300 },
+  { 63, 1767225600, -570 },
+  { 64, 1767225600, 720 },
+  { 64, 1775314799, 720 },
+  { 64, 1775314800, 660 },
+  { 64, 1791039599, 660 },
+  { 64, 1791039600, 720 },
+  { 64, 1806764399, 720 },
+  { 64, 1806764400, 660 },
+  { 64, 1822489199, 660 },
+  { 64, 1822489200, 720 },
+  { 64, 1838213999, 720 },
+  { 64, 1838214000, 660 },
+  { 64, 1853938799, 660 },
+  { 64, 1853938800, 720 },
+  { 64, 1869663599, 720 },
+  { 64, 1869663600, 660 },
+  { 64, 1885993199, 660 },
+  { 64, 1885993200, 720 },
+  { 64, 1901717999, 720 },
+  { 64, 1901718000, 660 },
+  { 64, 1917442799, 660 },
+  { 64, 1917442800, 720 },
+  { 64, 1933167599, 720 },
+  { 64, 1933167600, 660 },
+  { 64, 1948892399, 660 },
+  { 64, 1948892400, 720 },
+  { 64, 1964617199, 720 },
+  { 64, 1964617200, 660 },
+  { 64, 1980341999, 660 },
+  { 64, 1980342000, 720 },
+  { 64, 1996066799, 720 },
+  { 64, 1996066800, 660 },
+  { 64, 2011791599, 660 },
+  { 64, 2011791600, 720 },
+  { 64, 2027516399, 720 },
+  { 64, 2027516400, 660 },
+  { 64, 2043241199, 660 },
+  { 64, 2043241200, 720 },
+  { 64, 2058965999, 720 },
+  { 64, 2058966000, 660 },
+  { 64, 2075295599, 660 },
+  { 64, 2075295600, 720 },
+};